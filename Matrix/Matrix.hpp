@@ -1,14 +1,27 @@
 #pragma once
+#include "gemm.hpp"
 #include "mm.hpp"
+#include "simd.hpp"
+#include "structure.hpp"
+#include "view.hpp"
+// gcc reports a false maybe-uninitialized inside boost::rational::normalize depending on inlining
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
 #include <boost/multiprecision/cpp_dec_float.hpp>
 #include <boost/multiprecision/cpp_int.hpp>
 #include <boost/rational.hpp>
+#pragma GCC diagnostic pop
+#include <algorithm>
 #include <cstddef>
+#include <cmath>
 #include <exception>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <numeric>
 #include <stdexcept>
 #include <type_traits>
+#include <vector>
 
 namespace Linagl {
 
@@ -51,9 +64,56 @@ struct array_container {
 
 template <typename T>
 struct Matrix;
+// true for the lazy expressions built by +, - and *, see matrix_ref below
+template <typename E>
+struct is_expr : std::false_type {};
+template <typename T, typename U>
+struct is_expr<ConstMatrixView<T, U>> : std::true_type {};
+template <typename T>
+struct is_expr<MatrixView<T>> : std::true_type {};
 template <typename Number_t>
 Number_t det_LUP(Matrix<Number_t> mat);
 
+// Read-only h x w window of a matrix at (i0, j0) that goes through operator[],
+// so swapped rows are seen as they are and the storage is never touched. This
+// is what the structure analysis walks, copy() hands a block to the dense
+// determinant routines.
+template <typename T>
+struct matrix_window {
+    using value_type = T;
+
+    matrix_window(const Matrix<T> &mat, size_t i0, size_t j0, size_t h, size_t w)
+        : mat_(mat), i0_(i0), j0_(j0), Height_(h), Width_(w) {}
+
+    const T *operator[](size_t idx) const { return &mat_[i0_ + idx][0] + j0_; }
+    matrix_window block(size_t i0, size_t j0, size_t h, size_t w) const {
+        return {mat_, i0_ + i0, j0_ + j0, h, w};
+    }
+    Matrix<T> copy() const {
+        Matrix<T> res(Height_, Width_);
+        for (size_t i = 0; i < Height_; i++)
+            for (size_t j = 0; j < Width_; j++)
+                res[i][j] = (*this)[i][j];
+        return res;
+    }
+
+    size_t get_heigth() const { return Height_; }
+    size_t get_width() const { return Width_; }
+
+  private:
+    const Matrix<T> &mat_;
+    size_t i0_;
+    size_t j0_;
+    size_t Height_;
+    size_t Width_;
+};
+inline Long_number det_Bareiss(Matrix<Long_number> mat);
+template <typename T>
+bool det_certified(const Matrix<T> &mat, int digits, Long_real &det);
+template <typename T>
+Matrix<T> multiply(const Matrix<T> &a, const Matrix<T> &b, size_t strassen_cutoff = 0);
+inline Long_real round_digits(const Long_real &x, int digits);
+
 template <typename T>
 struct Matrix : private array_container<T> {
     using array_container<T>::data_;
@@ -116,15 +176,37 @@ struct Matrix : private array_container<T> {
     Matrix(Mat_t<T> &&rhs) = default;
     Mat_t<T> &operator=(Mat_t<T> &&rhs) = default;
 
+    template <typename E, typename = typename std::enable_if<is_expr<E>::value>::type>
+    Matrix(const E &expr) : Matrix(expr.rows(), expr.cols()) {
+        expr.assign_to(*this);
+    }
+    // evaluated in place unless the size changes or a product would read what it writes
+    template <typename E, typename = typename std::enable_if<is_expr<E>::value>::type>
+    Mat_t<T> &operator=(const E &expr) {
+        if (expr.rows() != Height_ || expr.cols() != Width_ || expr.aliased(this)) {
+            Mat_t<T> tmp(expr);
+            std::swap(*this, tmp);
+        } else {
+            expr.assign_to(*this);
+        }
+        return *this;
+    }
+
     row_t operator[](size_t idx) { return row_t{data_ + Width_ * row_perm_[idx]}; }
     const row_t operator[](size_t idx) const { return row_t{data_ + Width_ * row_perm_[idx]}; }
 
+    // structured matrices (triangular, tridiagonal, banded, block diagonal) skip the dense elimination
     Long_number det_integer() const {
         if (Width_ != Height_)
             return Long_number{};
         try {
-            auto res = det_LUP(Mat_t<Number_ext>{*this});
-            return res.numerator();
+            const matrix_window<T> whole(*this, 0, 0, Height_, Width_);
+            auto shape = analyze_structure(whole);
+            if (shape.kind != structure_kind_t::dense)
+                return det_structured<Number_ext>(whole, shape, [](const matrix_window<T> &block) {
+                           return block.copy().det_integer();
+                       }).numerator();
+            return det_integer(std::is_integral<T>{});
         } catch (std::exception &e) {
             std::throw_with_nested(e);
         }
@@ -134,6 +216,12 @@ struct Matrix : private array_container<T> {
         if (Width_ != Height_)
             return Long_real{};
         try {
+            const matrix_window<T> whole(*this, 0, 0, Height_, Width_);
+            auto shape = analyze_structure(whole);
+            if (shape.kind != structure_kind_t::dense)
+                return det_structured<Long_real>(whole, shape, [](const matrix_window<T> &block) {
+                    return block.copy().det_real();
+                });
             auto res = det_LUP(Mat_t<Long_real>{*this});
             return res;
         } catch (std::exception &e) {
@@ -141,6 +229,22 @@ struct Matrix : private array_container<T> {
         }
     }
 
+    // determinant rounded to `digits` decimal places, multiprecision only if double can't certify it
+    Long_real det_real(int digits) const {
+        if (Width_ != Height_)
+            return Long_real{};
+        Long_real res;
+        if (!det_certified(*this, digits, res))
+            res = round_digits(det_real(), digits);
+        return res;
+    }
+
+    // Views over the whole storage. Rows are looked up in the row permutation,
+    // so swapped rows are seen in their current order, also by views taken
+    // before the swap, and the storage is never moved.
+    MatrixView<T> view() { return {data_, Height_, Width_, Width_, 1, this, row_perm_.data()}; }
+    ConstMatrixView<T> view() const { return {data_, Height_, Width_, Width_, 1, this, row_perm_.data()}; }
+
     void swap_row(size_t i, size_t j) noexcept {
         if (i == j)
             return;
@@ -154,12 +258,26 @@ struct Matrix : private array_container<T> {
     size_t Height_;
     size_t Width_;
     std::vector<size_t> row_perm_;
+
+    // integral entries stay integral through fraction-free elimination, anything else goes through rationals
+    Long_number det_integer(std::true_type) const { return det_Bareiss(Mat_t<Long_number>{*this}); }
+    Long_number det_integer(std::false_type) const { return det_LUP(Mat_t<Number_ext>{*this}).numerator(); }
 };
 
+// y -= factor * x, float and double rows go through the SIMD kernels
+template <typename T>
+void row_sub(T *y, const T *x, const T &factor, size_t n) {
+    for (size_t k = 0; k < n; k++)
+        y[k] -= factor * x[k];
+}
+inline void row_sub(double *y, const double *x, double factor, size_t n) { simd::axpy(y, x, -factor, n); }
+inline void row_sub(float *y, const float *x, float factor, size_t n) { simd::axpy(y, x, -factor, n); }
+
 template <typename Number_t>
 Number_t det_LUP(Matrix<Number_t> mat) {
     using boost::abs;
     using boost::multiprecision::abs;
+    using std::abs;
     const size_t N = mat.get_heigth();
 
     auto &C = mat;
@@ -182,8 +300,7 @@ Number_t det_LUP(Matrix<Number_t> mat) {
 
         for (size_t j = i + 1; j < N; j++) {
             C[j][i] /= C[i][i];
-            for (size_t k = i + 1; k < N; k++)
-                C[j][k] -= C[j][i] * C[i][k];
+            row_sub(&C[j][0] + i + 1, &C[i][0] + i + 1, C[j][i], N - i - 1);
         }
     }
 
@@ -193,6 +310,173 @@ Number_t det_LUP(Matrix<Number_t> mat) {
     return res;
 }
 
+// the elimination works on its own copy anyway, so a view is converted straight into it
+template <typename Number_t, typename U>
+Number_t det_LUP(const ConstMatrixView<Number_t, U> &view) {
+    return det_LUP(Matrix<Number_t>(view));
+}
+
+// Fraction-free Gaussian elimination (Bareiss): after step k every entry of the
+// trailing submatrix is a (k+1)x(k+1) minor, so the division by the previous
+// pivot is exact and the entries never grow beyond the size of the determinant.
+inline Long_number det_Bareiss(Matrix<Long_number> mat) {
+    const size_t N = mat.get_heigth();
+
+    auto &C = mat;
+    bool negative = false;
+    Long_number prev_pivot = 1;
+
+    for (size_t i = 0; i < N; i++) {
+        if (C[i][i] == 0) {
+            size_t pivot = i + 1;
+            while (pivot < N && C[pivot][i] == 0)
+                pivot++;
+            if (pivot == N)
+                return Long_number{};
+            C.swap_row(pivot, i);
+            negative = !negative;
+        }
+
+        for (size_t j = i + 1; j < N; j++) {
+            for (size_t k = i + 1; k < N; k++) {
+                C[j][k] *= C[i][i];
+                C[j][k] -= C[j][i] * C[i][k];
+                C[j][k] /= prev_pivot;
+            }
+        }
+        prev_pivot = C[i][i];
+    }
+
+    return negative ? Long_number{-prev_pivot} : prev_pivot;
+}
+
+inline Long_real round_digits(const Long_real &x, int digits) {
+    auto ten_pow = boost::multiprecision::pow(Long_real(10), digits);
+    return boost::multiprecision::round(x * ten_pow) / ten_pow;
+}
+
+// Determinant in hardware double with a rigorous error bound. Partial pivoting
+// gives LU = PA + dA with |dA| <= g |L||U|, g = (n + 1)u / (1 - (n + 1)u), and by
+// multilinearity and Hadamard's inequality
+//   |det(A + dA) - det(A)| <= prod ||a_i|| * (prod (1 + ||da_i|| / ||a_i||) - 1),
+// the product of the pivots adds g |det|. Returns false if the value rounded to
+// `digits` decimal places isn't pinned down by the bound. If every entry is a
+// multiple of 2^-k, det * 2^(kn) is an integer, so an error below 2^-(kn) / 2
+// gives the exact determinant; integer matrices are the case k = 0. Other
+// inputs only certify when the bound is below the decimal cutoff itself, which
+// for 16 places takes |det| and the row norms well below 1.
+template <typename T>
+bool det_certified(const Matrix<T> &, int, Long_real &, std::false_type) {
+    return false;
+}
+
+template <typename T>
+bool det_certified(const Matrix<T> &mat, int digits, Long_real &det, std::true_type) {
+    const size_t N = mat.get_heigth();
+
+    // det of the matrix scaled by 2^scale has to stay exact in Long_real: at most 16
+    // digits of integer times 2^-(scale n), whose decimal expansion needs 0.7 digits a bit
+    const int max_scale_bits = 48;
+    std::vector<double> C(N * N);
+    int scale = 0;
+    double log_growth = 0;
+    double log_norms = 0;
+    for (size_t i = 0; i < N; i++) {
+        double norm = 0;
+        for (size_t j = 0; j < N; j++) {
+            double a = static_cast<double>(mat[i][j]);
+            if (static_cast<T>(a) != mat[i][j] || !std::isfinite(a))
+                return false;
+            while (scale * static_cast<int>(N) <= max_scale_bits &&
+                   std::trunc(std::ldexp(a, scale)) != std::ldexp(a, scale))
+                scale++;
+            norm += a * a;
+            C[i * N + j] = a;
+        }
+        if (norm == 0) {
+            det = 0;
+            return true;
+        }
+        log_norms += 0.5 * std::log(norm);
+    }
+
+    double d = 1;
+    std::vector<size_t> perm(N);
+    std::iota(perm.begin(), perm.end(), 0);
+    for (size_t i = 0; i < N; i++) {
+        size_t pivot = i + simd::iamax(&C[i * N + i], N - i, N);
+        if (pivot != i) {
+            std::swap_ranges(&C[i * N], &C[i * N] + N, &C[pivot * N]);
+            std::swap(perm[i], perm[pivot]);
+            d = -d;
+        }
+
+        double *row_i = &C[i * N];
+        d *= row_i[i];
+        if (row_i[i] == 0)
+            continue;
+        for (size_t j = i + 1; j < N; j++) {
+            double *row_j = &C[j * N];
+            row_j[i] /= row_i[i];
+            simd::axpy(row_j + i + 1, row_i + i + 1, -row_j[i], N - i - 1);
+        }
+    }
+
+    const double u = std::numeric_limits<double>::epsilon() / 2;
+    const double g = (N + 1) * u / (1 - (N + 1) * u);
+
+    // ||da_i|| <= g * ||(|L||U|)_i|| <= g * sum_k |l_ik| ||u_k||, rows of U first
+    std::vector<double> u_norm(N);
+    for (size_t k = 0; k < N; k++) {
+        double norm = 0;
+        for (size_t j = k; j < N; j++)
+            norm += C[k * N + j] * C[k * N + j];
+        u_norm[k] = std::sqrt(norm);
+    }
+    for (size_t i = 0; i < N; i++) {
+        double lu = u_norm[i];
+        for (size_t k = 0; k < i; k++)
+            lu += std::fabs(C[i * N + k]) * u_norm[k];
+
+        double a_norm = 0;
+        for (size_t j = 0; j < N; j++)
+            a_norm += static_cast<double>(mat[perm[i]][j]) * static_cast<double>(mat[perm[i]][j]);
+        log_growth += std::log1p(g * lu / std::sqrt(a_norm));
+    }
+
+    // The bound itself is evaluated in round to nearest. It is built from k = O(n)
+    // additions and products of nonnegative terms, square roots and log/exp of
+    // libm (a few ulp each), so the computed value is at least (1 - gamma_k) of
+    // the exact one, gamma_k = k u / (1 - k u), plus a relative error of about
+    // |log_norms| k u passed through exp. log_norms < 710, else err overflows and
+    // is rejected, so both stay far below 1/4 for any n below 10^10 and doubling
+    // the computed value bounds the exact one.
+    double err = 2 * (std::exp(log_norms) * std::expm1(log_growth) + g * std::fabs(d));
+    if (!std::isfinite(d) || !std::isfinite(err))
+        return false;
+
+    if (scale * static_cast<int>(N) <= max_scale_bits) {
+        const int bits = scale * static_cast<int>(N);
+        if (std::ldexp(err, bits) >= 0.5)
+            return false;
+        det = Long_real(std::nearbyint(std::ldexp(d, bits)));
+        if (bits)
+            det = round_digits(det * boost::multiprecision::pow(Long_real(0.5), bits), digits);
+        return true;
+    }
+    auto lo = round_digits(Long_real(d) - err, digits);
+    auto hi = round_digits(Long_real(d) + err, digits);
+    if (lo != hi)
+        return false;
+    det = lo;
+    return true;
+}
+
+template <typename T>
+bool det_certified(const Matrix<T> &mat, int digits, Long_real &det) {
+    return det_certified(mat, digits, det, std::is_arithmetic<T>{});
+}
+
 template <typename T>
 std::ostream &operator<<(std::ostream &stream, const Matrix<T> &mat) {
     for (size_t i = 0; i < mat.get_heigth(); i++) {
@@ -211,4 +495,276 @@ std::istream &operator>>(std::istream &stream, Matrix<T> &mat) {
     return stream;
 }
 
+// c += a * b, float and double go through the packed GEMM, anything else (integers,
+// cpp_int, rationals) through a plain i-p-j loop that skips zero entries of a
+template <typename T>
+void multiply_add(Matrix<T> &c, const Matrix<T> &a, const Matrix<T> &b, std::true_type) {
+    std::vector<const T *> a_rows(a.get_heigth()), b_rows(b.get_heigth());
+    std::vector<T *> c_rows(c.get_heigth());
+    for (size_t i = 0; i < a.get_heigth(); i++)
+        a_rows[i] = &a[i][0];
+    for (size_t i = 0; i < b.get_heigth(); i++)
+        b_rows[i] = &b[i][0];
+    for (size_t i = 0; i < c.get_heigth(); i++)
+        c_rows[i] = &c[i][0];
+    gemm::multiply_add(a.get_heigth(), b.get_width(), a.get_width(), a_rows.data(), b_rows.data(), c_rows.data());
+}
+
+template <typename T>
+void multiply_add(Matrix<T> &c, const Matrix<T> &a, const Matrix<T> &b, std::false_type) {
+    for (size_t i = 0; i < a.get_heigth(); i++)
+        for (size_t p = 0; p < a.get_width(); p++) {
+            const T &factor = a[i][p];
+            if (factor == T{})
+                continue;
+            for (size_t j = 0; j < b.get_width(); j++)
+                c[i][j] += factor * b[p][j];
+        }
+}
+
+// Lazy arithmetic: +, - and * build expression objects and nothing is computed
+// until one is assigned to a Matrix. A chain of sums and differences is then
+// evaluated in a single loop with no temporaries, and a product standing first
+// in the chain is multiplied straight into the destination, the rest of the chain
+// is accumulated on top of it. A product anywhere else is evaluated once into its
+// own temporary on first access. Every expression provides
+//  - rows(), cols() and at(i, j),
+//  - assign_to(dst), which overwrites a dst of the right size,
+//  - references(p), true if the matrix at p is one of the operands,
+//  - aliased(p), true if assign_to(*p) would read elements it has already written.
+template <typename T>
+struct matrix_ref {
+    using value_type = T;
+    static constexpr bool product_first = false;
+
+    matrix_ref(const Matrix<T> &mat) : mat_(mat) {}
+
+    size_t rows() const { return mat_.get_heigth(); }
+    size_t cols() const { return mat_.get_width(); }
+    const T &at(size_t i, size_t j) const { return mat_[i][j]; }
+    const Matrix<T> &matrix() const { return mat_; }
+
+    void assign_to(Matrix<T> &dst) const {
+        for (size_t i = 0; i < rows(); i++)
+            for (size_t j = 0; j < cols(); j++)
+                dst[i][j] = mat_[i][j];
+    }
+    bool references(const void *p) const { return p == &mat_; }
+    bool aliased(const void *) const { return false; }
+
+  private:
+    const Matrix<T> &mat_;
+};
+
+template <typename T>
+struct is_expr<matrix_ref<T>> : std::true_type {};
+
+// the expression form of an operand: matrices are wrapped, expressions are kept as is
+template <typename E>
+struct expr_of {
+    using type = E;
+};
+template <typename T>
+struct expr_of<Matrix<T>> {
+    using type = matrix_ref<T>;
+};
+
+struct plus_op {
+    template <typename T>
+    static T apply(const T &lhs, const T &rhs) {
+        return lhs + rhs;
+    }
+    template <typename T>
+    static void update(T &lhs, const T &rhs) {
+        lhs += rhs;
+    }
+};
+
+struct minus_op {
+    template <typename T>
+    static T apply(const T &lhs, const T &rhs) {
+        return lhs - rhs;
+    }
+    template <typename T>
+    static void update(T &lhs, const T &rhs) {
+        lhs -= rhs;
+    }
+};
+
+template <typename L, typename R, typename Op>
+struct elementwise_expr {
+    using value_type = typename L::value_type;
+    static_assert(std::is_same<value_type, typename R::value_type>::value, "operands of different element types");
+    static constexpr bool product_first = L::product_first;
+
+    elementwise_expr(const L &lhs, const R &rhs) : lhs_(lhs), rhs_(rhs) {
+        if (lhs.rows() != rhs.rows() || lhs.cols() != rhs.cols())
+            throw std::invalid_argument("sizes of the operands don't match");
+    }
+
+    size_t rows() const { return lhs_.rows(); }
+    size_t cols() const { return lhs_.cols(); }
+    value_type at(size_t i, size_t j) const { return Op::template apply<value_type>(lhs_.at(i, j), rhs_.at(i, j)); }
+
+    void assign_to(Matrix<value_type> &dst) const {
+        if (product_first) {
+            lhs_.assign_to(dst);
+            for (size_t i = 0; i < rows(); i++)
+                for (size_t j = 0; j < cols(); j++)
+                    Op::template update<value_type>(dst[i][j], rhs_.at(i, j));
+            return;
+        }
+        for (size_t i = 0; i < rows(); i++)
+            for (size_t j = 0; j < cols(); j++)
+                dst[i][j] = at(i, j);
+    }
+    bool references(const void *p) const { return lhs_.references(p) || rhs_.references(p); }
+    bool aliased(const void *p) const {
+        return lhs_.aliased(p) || rhs_.aliased(p) || (product_first && rhs_.references(p));
+    }
+
+  private:
+    L lhs_;
+    R rhs_;
+};
+
+template <typename L, typename R, typename Op>
+struct is_expr<elementwise_expr<L, R, Op>> : std::true_type {};
+
+// a factor that is a matrix is used in place, any other expression is evaluated first
+template <typename T>
+const Matrix<T> &factor_of(const matrix_ref<T> &expr) {
+    return expr.matrix();
+}
+template <typename E>
+Matrix<typename E::value_type> factor_of(const E &expr) {
+    return Matrix<typename E::value_type>(expr);
+}
+
+template <typename L, typename R>
+struct product_expr {
+    using value_type = typename L::value_type;
+    static_assert(std::is_same<value_type, typename R::value_type>::value, "factors of different element types");
+    static constexpr bool product_first = true;
+
+    product_expr(const L &lhs, const R &rhs) : lhs_(lhs), rhs_(rhs) {
+        if (lhs.cols() != rhs.rows())
+            throw std::invalid_argument("sizes of the factors don't match");
+    }
+
+    size_t rows() const { return lhs_.rows(); }
+    size_t cols() const { return rhs_.cols(); }
+    const value_type &at(size_t i, size_t j) const {
+        if (!value_)
+            value_ = std::make_shared<Matrix<value_type>>(*this);
+        return (*value_)[i][j];
+    }
+
+    void assign_to(Matrix<value_type> &dst) const {
+        for (size_t i = 0; i < rows(); i++)
+            for (size_t j = 0; j < cols(); j++)
+                dst[i][j] = value_type{};
+        if (rows() == 0 || cols() == 0 || lhs_.cols() == 0)
+            return;
+        const auto &a = factor_of(lhs_);
+        const auto &b = factor_of(rhs_);
+        multiply_add(dst, a, b, std::is_floating_point<value_type>{});
+    }
+    bool references(const void *p) const { return lhs_.references(p) || rhs_.references(p); }
+    bool aliased(const void *p) const { return references(p); }
+
+  private:
+    L lhs_;
+    R rhs_;
+    mutable std::shared_ptr<Matrix<value_type>> value_;
+};
+
+template <typename L, typename R>
+struct is_expr<product_expr<L, R>> : std::true_type {};
+
+template <typename X>
+struct is_operand : is_expr<typename expr_of<X>::type> {};
+
+template <typename L, typename R>
+using if_operands = typename std::enable_if<is_operand<L>::value && is_operand<R>::value>::type;
+
+template <typename L, typename R, typename = if_operands<L, R>>
+elementwise_expr<typename expr_of<L>::type, typename expr_of<R>::type, plus_op> operator+(const L &lhs, const R &rhs) {
+    return {lhs, rhs};
+}
+
+template <typename L, typename R, typename = if_operands<L, R>>
+elementwise_expr<typename expr_of<L>::type, typename expr_of<R>::type, minus_op> operator-(const L &lhs, const R &rhs) {
+    return {lhs, rhs};
+}
+
+template <typename L, typename R, typename = if_operands<L, R>>
+product_expr<typename expr_of<L>::type, typename expr_of<R>::type> operator*(const L &lhs, const R &rhs) {
+    return {lhs, rhs};
+}
+
+// h x w block of mat at (i0, j0), the part outside of mat is zero
+template <typename T>
+Matrix<T> sub_block(const Matrix<T> &mat, size_t i0, size_t j0, size_t h, size_t w) {
+    Matrix<T> res(h, w);
+    for (size_t i = i0; i < std::min(i0 + h, mat.get_heigth()); i++)
+        for (size_t j = j0; j < std::min(j0 + w, mat.get_width()); j++)
+            res[i - i0][j - j0] = mat[i][j];
+    return res;
+}
+
+// Strassen-Winograd: 7 products of half size and 15 additions per level while all
+// three dimensions exceed the cutoff. Odd sizes are padded with zeros in the
+// quadrants and the padding is cut off when the result is assembled.
+template <typename T>
+Matrix<T> multiply_strassen(const Matrix<T> &a, const Matrix<T> &b, size_t cutoff) {
+    const size_t m = a.get_heigth(), k = a.get_width(), n = b.get_width();
+    if (std::min({m, k, n}) <= std::max<size_t>(cutoff, 1))
+        return multiply(a, b);
+    const size_t m2 = (m + 1) / 2, k2 = (k + 1) / 2, n2 = (n + 1) / 2;
+    auto A11 = sub_block(a, 0, 0, m2, k2), A12 = sub_block(a, 0, k2, m2, k2);
+    auto A21 = sub_block(a, m2, 0, m2, k2), A22 = sub_block(a, m2, k2, m2, k2);
+    auto B11 = sub_block(b, 0, 0, k2, n2), B12 = sub_block(b, 0, n2, k2, n2);
+    auto B21 = sub_block(b, k2, 0, k2, n2), B22 = sub_block(b, k2, n2, k2, n2);
+
+    Matrix<T> S1 = A21 + A22;
+    Matrix<T> S2 = S1 - A11;
+    Matrix<T> S3 = A11 - A21;
+    Matrix<T> S4 = A12 - S2;
+    Matrix<T> T1 = B12 - B11;
+    Matrix<T> T2 = B22 - T1;
+    Matrix<T> T3 = B22 - B12;
+    Matrix<T> T4 = T2 - B21;
+
+    Matrix<T> P1 = multiply_strassen(A11, B11, cutoff);
+    Matrix<T> U2 = P1 + multiply_strassen(S2, T2, cutoff);
+    Matrix<T> U3 = U2 + multiply_strassen(S3, T3, cutoff);
+    Matrix<T> P5 = multiply_strassen(S1, T1, cutoff);
+    Matrix<T> C11 = P1 + multiply_strassen(A12, B21, cutoff);
+    Matrix<T> C12 = U2 + P5 + multiply_strassen(S4, B22, cutoff);
+    Matrix<T> C21 = U3 - multiply_strassen(A22, T4, cutoff);
+    Matrix<T> C22 = U3 + P5;
+
+    Matrix<T> c(m, n);
+    for (size_t i = 0; i < m; i++)
+        for (size_t j = 0; j < n; j++) {
+            const auto &quarter = i < m2 ? (j < n2 ? C11 : C12) : (j < n2 ? C21 : C22);
+            c[i][j] = quarter[i % m2][j % n2];
+        }
+    return c;
+}
+
+// a * b, the Strassen-Winograd recursion is used above `strassen_cutoff` if it's nonzero
+template <typename T>
+Matrix<T> multiply(const Matrix<T> &a, const Matrix<T> &b, size_t strassen_cutoff) {
+    if (a.get_width() != b.get_heigth())
+        throw std::invalid_argument("sizes of the factors don't match");
+    if (strassen_cutoff != 0)
+        return multiply_strassen(a, b, strassen_cutoff);
+    Matrix<T> c(a.get_heigth(), b.get_width());
+    if (c.get_heigth() != 0 && c.get_width() != 0 && a.get_width() != 0)
+        multiply_add(c, a, b, std::is_floating_point<T>{});
+    return c;
+}
+
 } // namespace Linagl
@@ -0,0 +1,56 @@
+#pragma once
+#include "Matrix.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Linagl {
+
+// Exact determinants of `count` size x size matrices read from `in`, one per
+// line of `out` in input order. The stream is parsed on the calling thread
+// while chunks of `chunk` matrices are evaluated and printed to text on the
+// pool; at most two chunks per worker are in flight, so memory stays bounded
+// however long the stream is. Returns the number of matrices processed.
+template <typename T>
+size_t det_batch(std::istream &in, std::ostream &out, size_t count, size_t size, thread_pool_t &pool,
+                 size_t chunk = 256) {
+    chunk = std::max<size_t>(chunk, 1);
+    std::deque<std::future<std::string>> in_flight;
+    auto flush_one = [&]() {
+        out << in_flight.front().get();
+        in_flight.pop_front();
+    };
+
+    size_t done = 0;
+    while (done < count) {
+        std::vector<Matrix<T>> matrices;
+        for (size_t i = 0; i < chunk && done < count && in; i++, done++) {
+            matrices.emplace_back(size, size);
+            in >> matrices.back();
+        }
+        if (!in)
+            throw std::runtime_error("the input ended before " + std::to_string(count) + " matrices");
+
+        if (in_flight.size() >= 2 * pool.size())
+            flush_one();
+        auto task = std::make_shared<std::vector<Matrix<T>>>(std::move(matrices));
+        in_flight.push_back(pool.submit([task]() {
+            std::ostringstream text;
+            for (const auto &mat : *task)
+                text << mat.det_integer() << '\n';
+            return text.str();
+        }));
+    }
+    while (!in_flight.empty())
+        flush_one();
+    return done;
+}
+
+} // namespace Linagl
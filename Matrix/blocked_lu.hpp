@@ -0,0 +1,226 @@
+#pragma once
+#include "Matrix.hpp"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+namespace Linagl {
+
+namespace tiles {
+// tiles are a whole number of columns of the widest GEMM micro-kernel
+enum : size_t { align = 16 };
+} // namespace tiles
+
+// Square matrix split into block x block tiles, every tile is a contiguous
+// row-major array and tiles follow each other row by row. The size is padded up
+// to a whole number of tiles with an identity block, which keeps the determinant.
+template <typename T>
+struct tiled_matrix {
+    tiled_matrix(size_t n, size_t block)
+        : n_(n), block_((std::max<size_t>(block, 1) + tiles::align - 1) / tiles::align * tiles::align),
+          tiles_((n + block_ - 1) / block_), data_(tiles_ * tiles_ * block_ * block_, T{}) {
+        for (size_t i = n_; i < tiles_ * block_; i++)
+            at(i, i) = T{1};
+    }
+
+    template <typename U>
+    tiled_matrix(const Matrix<U> &mat, size_t block) : tiled_matrix(mat.get_heigth(), block) {
+        fill(mat);
+    }
+    template <typename U, typename V>
+    tiled_matrix(const ConstMatrixView<U, V> &mat, size_t block) : tiled_matrix(mat.get_heigth(), block) {
+        fill(mat);
+    }
+
+    T *tile(size_t ti, size_t tj) { return &data_[(ti * tiles_ + tj) * block_ * block_]; }
+    const T *tile(size_t ti, size_t tj) const { return &data_[(ti * tiles_ + tj) * block_ * block_]; }
+
+    T &at(size_t i, size_t j) { return tile(i / block_, j / block_)[(i % block_) * block_ + j % block_]; }
+    const T &at(size_t i, size_t j) const { return tile(i / block_, j / block_)[(i % block_) * block_ + j % block_]; }
+
+    size_t size() const { return n_; }
+    size_t padded_size() const { return tiles_ * block_; }
+    size_t block() const { return block_; }
+    size_t tiles() const { return tiles_; }
+
+  private:
+    size_t n_;
+    size_t block_;
+    size_t tiles_;
+    std::vector<T> data_;
+
+    template <typename Mat>
+    void fill(const Mat &mat) {
+        for (size_t i = 0; i < n_; i++)
+            for (size_t j = 0; j < n_; j++)
+                at(i, j) = static_cast<T>(mat[i][j]);
+    }
+};
+
+namespace tiles {
+
+// c -= a * b on block x block tiles, a Rows x Cols piece of c is accumulated in
+// registers over the whole inner dimension. The wrappers below compile it for
+// each ISA with a register block that fills its vector registers.
+template <size_t Rows, size_t Cols, typename T>
+inline __attribute__((always_inline)) void gemm_kernel(T *c, const T *a, const T *b, size_t block) {
+    for (size_t i = 0; i < block; i += Rows)
+        for (size_t j = 0; j < block; j += Cols) {
+            T acc[Rows][Cols] = {};
+            for (size_t p = 0; p < block; p++) {
+                const T *b_row = b + p * block + j;
+                for (size_t r = 0; r < Rows; r++) {
+                    const T factor = a[(i + r) * block + p];
+                    for (size_t jj = 0; jj < Cols; jj++)
+                        acc[r][jj] += factor * b_row[jj];
+                }
+            }
+            for (size_t r = 0; r < Rows; r++)
+                for (size_t jj = 0; jj < Cols; jj++)
+                    c[(i + r) * block + j + jj] -= acc[r][jj];
+        }
+}
+
+#ifdef LINAGL_X86_DISPATCH
+LINAGL_TARGET("avx2,fma") inline void gemm_avx2(double *c, const double *a, const double *b, size_t block) {
+    gemm_kernel<4, 8>(c, a, b, block);
+}
+LINAGL_TARGET("avx2,fma") inline void gemm_avx2(float *c, const float *a, const float *b, size_t block) {
+    gemm_kernel<4, 16>(c, a, b, block);
+}
+LINAGL_TARGET("avx512f,prefer-vector-width=512")
+inline void gemm_avx512(double *c, const double *a, const double *b, size_t block) {
+    gemm_kernel<4, 16>(c, a, b, block);
+}
+LINAGL_TARGET("avx512f,prefer-vector-width=512")
+inline void gemm_avx512(float *c, const float *a, const float *b, size_t block) {
+    gemm_kernel<8, 16>(c, a, b, block);
+}
+#endif
+
+template <typename T>
+void gemm(T *c, const T *a, const T *b, size_t block) {
+#ifdef LINAGL_X86_DISPATCH
+    switch (simd::active_isa()) {
+    case simd::isa_t::avx512:
+        return gemm_avx512(c, a, b, block);
+    case simd::isa_t::avx2:
+        return gemm_avx2(c, a, b, block);
+    case simd::isa_t::scalar:
+        break;
+    }
+#endif
+    gemm_kernel<4, 4>(c, a, b, block);
+}
+
+// b = L^-1 b, L is the unit lower triangle of the tile
+template <typename T>
+void trsm(T *b, const T *l, size_t block) {
+    for (size_t i = 1; i < block; i++)
+        for (size_t p = 0; p < i; p++)
+            simd::axpy(b + i * block, b + p * block, -l[i * block + p], block);
+}
+
+// swaps rows r1 and r2 of the whole tile column tj
+template <typename T>
+void swap_rows(tiled_matrix<T> &A, size_t tj, size_t r1, size_t r2) {
+    if (r1 == r2)
+        return;
+    const size_t b = A.block();
+    T *row1 = A.tile(r1 / b, tj) + (r1 % b) * b;
+    T *row2 = A.tile(r2 / b, tj) + (r2 % b) * b;
+    std::swap_ranges(row1, row1 + b, row2);
+}
+
+// unblocked partial pivoting LU of the tall panel made of tile column k below the diagonal
+template <typename T>
+void panel(tiled_matrix<T> &A, size_t k, std::vector<size_t> &pivots) {
+    const size_t b = A.block();
+    const size_t n = A.padded_size();
+    for (size_t cc = 0; cc < b; cc++) {
+        const size_t col = k * b + cc;
+        // column col of every tile below the diagonal is a stride b vector
+        size_t pivot = col + simd::iamax(A.tile(k, k) + cc * b + cc, b - cc, b);
+        for (size_t ti = k + 1; ti < n / b; ti++) {
+            size_t r = ti * b + simd::iamax(A.tile(ti, k) + cc, b, b);
+            if (std::fabs(A.at(r, col)) > std::fabs(A.at(pivot, col)))
+                pivot = r;
+        }
+        pivots[col] = pivot;
+        swap_rows(A, k, col, pivot);
+
+        const T diag = A.at(col, col);
+        if (diag == T{})
+            continue;
+        const T *row_c = A.tile(k, k) + cc * b;
+        for (size_t r = col + 1; r < n; r++) {
+            T *row_r = A.tile(r / b, k) + (r % b) * b;
+            row_r[cc] /= diag;
+            simd::axpy(row_r + cc + 1, row_c + cc + 1, -row_r[cc], b - cc - 1);
+        }
+    }
+}
+
+} // namespace tiles
+
+// Right-looking blocked LU in place: the panel of every tile column is factored
+// with partial pivoting, its row swaps are applied to the other tile columns,
+// the tile row to the right is solved with the unit lower diagonal tile and the
+// trailing tiles get a tile-by-tile GEMM update. pivots[i] is the row swapped with i.
+template <typename T>
+void lu_blocked(tiled_matrix<T> &A, std::vector<size_t> &pivots) {
+    static_assert(std::is_floating_point<T>::value, "blocked LU is for float and double");
+    const size_t b = A.block();
+    const size_t nt = A.tiles();
+    pivots.assign(A.padded_size(), 0);
+
+    for (size_t k = 0; k < nt; k++) {
+        tiles::panel(A, k, pivots);
+        for (size_t tj = 0; tj < nt; tj++)
+            if (tj != k)
+                for (size_t r = k * b; r < (k + 1) * b; r++)
+                    tiles::swap_rows(A, tj, r, pivots[r]);
+
+        for (size_t tj = k + 1; tj < nt; tj++)
+            tiles::trsm(A.tile(k, tj), A.tile(k, k), b);
+        for (size_t ti = k + 1; ti < nt; ti++)
+            for (size_t tj = k + 1; tj < nt; tj++)
+                tiles::gemm(A.tile(ti, tj), A.tile(ti, k), A.tile(k, tj), b);
+    }
+}
+
+// product of the pivots, accumulated in Long_real so that it doesn't overflow
+template <typename T>
+Long_real det_factored(const tiled_matrix<T> &A, const std::vector<size_t> &pivots) {
+    Long_real res = 1;
+    for (size_t i = 0; i < A.size(); i++) {
+        res *= A.at(i, i);
+        if (pivots[i] != i)
+            res = -res;
+    }
+    return res;
+}
+
+template <typename T>
+Long_real det_blocked(const Matrix<T> &mat, size_t block = 48) {
+    if (mat.get_width() != mat.get_heigth())
+        return Long_real{};
+    tiled_matrix<T> A(mat, block);
+    std::vector<size_t> pivots;
+    lu_blocked(A, pivots);
+    return det_factored(A, pivots);
+}
+
+// the view is read straight into the tiles, a converting view picks the precision
+template <typename T, typename U>
+Long_real det_blocked(const ConstMatrixView<T, U> &mat, size_t block = 48) {
+    if (mat.get_width() != mat.get_heigth())
+        return Long_real{};
+    tiled_matrix<T> A(mat, block);
+    std::vector<size_t> pivots;
+    lu_blocked(A, pivots);
+    return det_factored(A, pivots);
+}
+
+} // namespace Linagl
@@ -0,0 +1,200 @@
+#pragma once
+#include "Matrix.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace Linagl {
+
+namespace modular {
+
+using u64 = uint64_t;
+using u128 = unsigned __int128;
+
+// Arithmetic modulo an odd p < 2^62 on numbers kept in Montgomery form a * 2^64 mod p,
+// a product costs two 64x64 multiplications and no division.
+struct montgomery_t {
+    explicit montgomery_t(u64 p) : p_(p), r2_(static_cast<u64>((u128(1) << 64) % p * ((u128(1) << 64) % p) % p)) {
+        // Newton iteration for p^-1 mod 2^64, every step doubles the number of correct bits
+        u64 inv = p;
+        for (int i = 0; i < 5; i++)
+            inv *= 2 - p * inv;
+        neg_inv_ = 0 - inv;
+    }
+
+    u64 reduce(u128 t) const {
+        u64 m = static_cast<u64>(t) * neg_inv_;
+        u64 res = static_cast<u64>((t + u128(m) * p_) >> 64);
+        return res >= p_ ? res - p_ : res;
+    }
+
+    u64 to(u64 a) const { return reduce(u128(a % p_) * r2_); }
+    u64 from(u64 a) const { return reduce(a); }
+    u64 mul(u64 a, u64 b) const { return reduce(u128(a) * b); }
+    u64 sub(u64 a, u64 b) const { return a >= b ? a - b : a + p_ - b; }
+
+    u64 pow(u64 a, u64 e) const {
+        u64 res = to(1);
+        for (; e; e >>= 1, a = mul(a, a))
+            if (e & 1)
+                res = mul(res, a);
+        return res;
+    }
+    u64 inverse(u64 a) const { return pow(a, p_ - 2); }
+
+    u64 modulus() const { return p_; }
+
+  private:
+    u64 p_;
+    u64 r2_;
+    u64 neg_inv_;
+};
+
+inline u64 mul_mod(u64 a, u64 b, u64 p) { return static_cast<u64>(u128(a) * b % p); }
+
+inline u64 pow_mod(u64 a, u64 e, u64 p) {
+    u64 res = 1;
+    for (a %= p; e; e >>= 1, a = mul_mod(a, a, p))
+        if (e & 1)
+            res = mul_mod(res, a, p);
+    return res;
+}
+
+// Miller-Rabin with a base set that is deterministic for all 64-bit numbers
+inline bool is_prime(u64 n) {
+    if (n < 4)
+        return n > 1;
+    if (n % 2 == 0)
+        return false;
+    u64 d = n - 1;
+    int s = 0;
+    for (; d % 2 == 0; d /= 2)
+        s++;
+    for (u64 a : {2, 325, 9375, 28178, 450775, 9780504, 1795265022}) {
+        u64 x = pow_mod(a, d, n);
+        if (x == 0 || x == 1 || x == n - 1)
+            continue;
+        bool composite = true;
+        for (int r = 1; r < s && composite; r++) {
+            x = mul_mod(x, x, n);
+            composite = x != n - 1;
+        }
+        if (composite)
+            return false;
+    }
+    return true;
+}
+
+// the largest `count` primes below 2^62, every one of them is above 2^61
+inline std::vector<u64> primes(size_t count) {
+    static std::vector<u64> cache;
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (u64 n = cache.empty() ? (u64(1) << 62) - 1 : cache.back() - 2; cache.size() < count; n -= 2)
+        if (is_prime(n))
+            cache.push_back(n);
+    return std::vector<u64>(cache.begin(), cache.begin() + count);
+}
+
+template <typename T>
+u64 det_mod(const Matrix<T> &mat, u64 p) {
+    const size_t N = mat.get_heigth();
+    montgomery_t mg(p);
+
+    std::vector<u64> C(N * N);
+    for (size_t i = 0; i < N; i++)
+        for (size_t j = 0; j < N; j++) {
+            long long v = static_cast<long long>(mat[i][j]) % static_cast<long long>(p);
+            C[i * N + j] = mg.to(static_cast<u64>(v < 0 ? v + static_cast<long long>(p) : v));
+        }
+
+    u64 det = mg.to(1);
+    for (size_t i = 0; i < N; i++) {
+        size_t pivot = i;
+        while (pivot < N && C[pivot * N + i] == 0)
+            pivot++;
+        if (pivot == N)
+            return 0;
+        if (pivot != i) {
+            std::swap_ranges(&C[i * N], &C[i * N] + N, &C[pivot * N]);
+            det = mg.sub(0, det);
+        }
+
+        u64 *row_i = &C[i * N];
+        det = mg.mul(det, row_i[i]);
+        u64 inv = mg.inverse(row_i[i]);
+        for (size_t j = i + 1; j < N; j++) {
+            u64 *row_j = &C[j * N];
+            u64 factor = mg.mul(row_j[i], inv);
+            for (size_t k = i + 1; k < N; k++)
+                row_j[k] = mg.sub(row_j[k], mg.mul(factor, row_i[k]));
+        }
+    }
+    return mg.from(det);
+}
+
+// log2 of Hadamard's bound |det| <= prod_i ||row_i||, 0 rows give -inf
+template <typename T>
+double hadamard_bits(const Matrix<T> &mat) {
+    double bits = 0;
+    for (size_t i = 0; i < mat.get_heigth(); i++) {
+        long double norm = 0;
+        for (size_t j = 0; j < mat.get_width(); j++)
+            norm += static_cast<long double>(mat[i][j]) * static_cast<long double>(mat[i][j]);
+        bits += 0.5 * std::log2(static_cast<double>(norm));
+    }
+    return bits;
+}
+
+} // namespace modular
+
+// Determinant of an integer matrix from its residues modulo primes p_i < 2^62:
+// enough primes to cover twice Hadamard's bound are eliminated independently
+// on the pool, and the residues are combined by the Chinese remainder theorem
+// into the symmetric range (-M/2, M/2], M = prod p_i.
+template <typename T>
+Long_number det_modular(const Matrix<T> &mat, thread_pool_t &pool) {
+    static_assert(std::is_integral<T>::value && sizeof(T) <= sizeof(long long), "entries must fit in 64 bits");
+    if (mat.get_width() != mat.get_heigth())
+        return Long_number{};
+
+    double bits = modular::hadamard_bits(mat);
+    if (std::isinf(bits))
+        return Long_number{};
+    // each prime is above 2^61, one spare prime absorbs the rounding of the bound
+    size_t count = static_cast<size_t>(std::max(0.0, std::ceil((bits + 1) / 61))) + 1;
+    auto primes = modular::primes(count);
+
+    std::vector<std::future<modular::u64>> residues;
+    for (auto p : primes)
+        residues.push_back(pool.submit([&mat, p]() { return modular::det_mod(mat, p); }));
+
+    // Garner-style incremental CRT: x = r_i mod p_i for all i processed so far
+    Long_number x = 0;
+    Long_number M = 1;
+    for (size_t i = 0; i < primes.size(); i++) {
+        modular::u64 p = primes[i];
+        modular::u64 r = residues[i].get();
+        modular::u64 x_mod = static_cast<modular::u64>(x % p);
+        modular::u64 M_mod = static_cast<modular::u64>(M % p);
+        modular::u64 t = modular::mul_mod((r + p - x_mod) % p, modular::pow_mod(M_mod, p - 2, p), p);
+        x += M * t;
+        M *= p;
+    }
+    if (2 * x > M)
+        x -= M;
+    return x;
+}
+
+template <typename T>
+Long_number det_modular(const Matrix<T> &mat, size_t n_threads = 0) {
+    thread_pool_t pool(n_threads);
+    return det_modular(mat, pool);
+}
+
+} // namespace Linagl
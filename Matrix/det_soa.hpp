@@ -0,0 +1,150 @@
+#pragma once
+#include "fixed.hpp"
+#include "simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Determinants of many small float/double matrices of one size. Groups of L
+// matrices (4, 8 or 16 under AVX2/AVX-512, one per lane) are transposed into
+// structure-of-arrays layout, a[(i * n + j) * L + l] being entry (i, j) of the
+// l-th matrix, and eliminated in lockstep on gcc vector types: every step is
+// one vector instruction over the L lanes and nothing branches on the data.
+// Partial pivoting swaps rows by compare and blend, and a lane with a zero
+// column gets a zero determinant without dividing by zero.
+namespace Linagl {
+namespace soa {
+
+// unaligned moves between the SoA storage and vector registers; vectors are
+// never returned by value, which would change the ABI outside the target ISA
+template <typename V, typename T>
+inline __attribute__((always_inline)) void load(V &dst, const T *src) {
+    std::memcpy(&dst, src, sizeof(V));
+}
+
+template <typename V, typename T>
+inline __attribute__((always_inline)) void store(T *dst, const V &src) {
+    std::memcpy(dst, &src, sizeof(V));
+}
+
+// the group of L matrices in `a` is destroyed, det[l] gets the determinant of the l-th one
+template <size_t L, typename T>
+inline __attribute__((always_inline)) void det_lanes(T *a, size_t n, T *det) {
+    typedef T vec_t __attribute__((vector_size(L * sizeof(T))));
+    auto at = [=](size_t i, size_t j) { return a + (i * n + j) * L; };
+    const vec_t zero = {};
+    const vec_t one = zero + 1;
+    vec_t top, bottom;
+
+    vec_t res = one;
+    for (size_t k = 0; k < n; k++) {
+        // after comparing with row r, row k holds the largest |a_ik| of rows k .. r
+        for (size_t r = k + 1; r < n; r++) {
+            load(top, at(k, k));
+            load(bottom, at(r, k));
+            const auto swap = (bottom < zero ? -bottom : bottom) > (top < zero ? -top : top);
+            res = swap ? -res : res;
+            for (size_t c = k; c < n; c++) {
+                load(top, at(k, c));
+                load(bottom, at(r, c));
+                store(at(k, c), swap ? bottom : top);
+                store(at(r, c), swap ? top : bottom);
+            }
+        }
+
+        vec_t pivot;
+        load(pivot, at(k, k));
+        res *= pivot;
+        const vec_t inv = one / (pivot == zero ? one : pivot);
+        for (size_t r = k + 1; r < n; r++) {
+            load(bottom, at(r, k));
+            const vec_t factor = bottom * inv;
+            for (size_t c = k + 1; c < n; c++) {
+                load(top, at(k, c));
+                load(bottom, at(r, c));
+                store(at(r, c), bottom - factor * top);
+            }
+        }
+    }
+    store(det, res);
+}
+
+#ifdef LINAGL_X86_DISPATCH
+LINAGL_TARGET("avx2,fma") inline void det_avx2(double *a, size_t n, double *det) { det_lanes<4>(a, n, det); }
+LINAGL_TARGET("avx2,fma") inline void det_avx2(float *a, size_t n, float *det) { det_lanes<8>(a, n, det); }
+LINAGL_TARGET("avx512f,prefer-vector-width=512")
+inline void det_avx512(double *a, size_t n, double *det) { det_lanes<8>(a, n, det); }
+LINAGL_TARGET("avx512f,prefer-vector-width=512")
+inline void det_avx512(float *a, size_t n, float *det) { det_lanes<16>(a, n, det); }
+#endif
+
+// matrices per group for every ISA, must match the wrappers above; without
+// dispatch the group fills a 16 byte vector, which every x86-64 and NEON has
+template <typename T>
+size_t lanes(simd::isa_t isa) {
+    const size_t wide = sizeof(T) == sizeof(float) ? 2 : 1;
+    switch (isa) {
+    case simd::isa_t::avx512:
+        return 8 * wide;
+    case simd::isa_t::avx2:
+        return 4 * wide;
+    case simd::isa_t::scalar:
+        break;
+    }
+    return 2 * wide;
+}
+
+template <typename T>
+void det_group(simd::isa_t isa, T *a, size_t n, T *det) {
+#ifdef LINAGL_X86_DISPATCH
+    switch (isa) {
+    case simd::isa_t::avx512:
+        return det_avx512(a, n, det);
+    case simd::isa_t::avx2:
+        return det_avx2(a, n, det);
+    case simd::isa_t::scalar:
+        break;
+    }
+#endif
+    det_lanes<16 / sizeof(T)>(a, n, det);
+}
+
+// `entry(m, i, j)` reads entry (i, j) of the m-th matrix
+template <typename T, typename Entry>
+void det_all(size_t count, size_t n, Entry entry, T *dets) {
+    static_assert(std::is_floating_point<T>::value, "SoA determinants are for float and double");
+    const simd::isa_t isa = simd::active_isa();
+    const size_t L = lanes<T>(isa);
+    std::vector<T> a(n * n * L);
+    std::vector<T> det(L);
+    for (size_t m0 = 0; m0 < count; m0 += L) {
+        const size_t group = std::min(L, count - m0);
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+                for (size_t l = 0; l < L; l++)
+                    // the lanes past the end hold identity matrices
+                    a[(i * n + j) * L + l] = l < group ? T(entry(m0 + l, i, j)) : T(i == j);
+        det_group(isa, a.data(), n, det.data());
+        std::copy(det.begin(), det.begin() + group, dets + m0);
+    }
+}
+
+} // namespace soa
+
+// determinants of `count` n x n matrices stored one after another in row-major order
+template <typename T>
+void det_soa(const T *mats, size_t count, size_t n, T *dets) {
+    soa::det_all(count, n, [=](size_t m, size_t i, size_t j) { return mats[(m * n + i) * n + j]; }, dets);
+}
+
+template <typename T, size_t N>
+std::vector<T> det_soa(const std::vector<FixedMatrix<T, N, N>> &mats) {
+    std::vector<T> dets(mats.size());
+    soa::det_all(mats.size(), N, [&](size_t m, size_t i, size_t j) { return mats[m][i][j]; }, dets.data());
+    return dets;
+}
+
+} // namespace Linagl
@@ -0,0 +1,161 @@
+#pragma once
+#include "Matrix.hpp"
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace Linagl {
+
+// Matrix with sizes known at compile time, kept inline in std::array: no heap,
+// no row permutation, and constant expressions for literal T. An aggregate
+// filled row by row:
+//   constexpr FixedMatrix<int, 2, 2> mat = {1, 2, 3, 4};
+template <typename T, size_t N, size_t M>
+struct FixedMatrix {
+    static_assert(N > 0 && M > 0, "empty fixed matrix");
+    using row_type = std::array<T, M>;
+
+    std::array<row_type, N> data;
+
+    row_type &operator[](size_t idx) { return data[idx]; }
+    constexpr const row_type &operator[](size_t idx) const { return data[idx]; }
+
+    static constexpr size_t get_heigth() { return N; }
+    static constexpr size_t get_width() { return M; }
+
+    template <typename U>
+    static FixedMatrix from(const Matrix<U> &mat) {
+        if (mat.get_heigth() != N || mat.get_width() != M)
+            throw std::invalid_argument("sizes of the fixed matrix don't match");
+        FixedMatrix res;
+        for (size_t i = 0; i < N; i++)
+            for (size_t j = 0; j < M; j++)
+                res[i][j] = static_cast<T>(mat[i][j]);
+        return res;
+    }
+
+    Matrix<T> dynamic() const {
+        Matrix<T> res(N, M);
+        for (size_t i = 0; i < N; i++)
+            for (size_t j = 0; j < M; j++)
+                res[i][j] = data[i][j];
+        return res;
+    }
+};
+
+namespace fixed {
+
+template <typename T, size_t N>
+using rows_t = std::array<std::array<T, N>, N>;
+
+// a_r0c0 a_r1c1 - a_r0c1 a_r1c0
+template <typename T, size_t N>
+constexpr T minor2(const rows_t<T, N> &a, size_t r0, size_t r1, size_t c0, size_t c1) {
+    return a[r0][c0] * a[r1][c1] - a[r0][c1] * a[r1][c0];
+}
+
+// Elimination with each step and each row update a separate instantiation, so
+// every index is a constant and the whole factorization is straight-line code.
+// Floating point pivots on the largest entry, anything else runs fraction-free
+// Bareiss steps on the first nonzero one, which keeps integers exact as long as
+// T holds products of two minors, about the square of the determinant.
+template <size_t K, size_t J, size_t N>
+struct update_rows {
+    template <typename T>
+    static void run(rows_t<T, N> &a, const T &, std::true_type) {
+        const T factor = a[J][K] / a[K][K];
+        for (size_t c = K + 1; c < N; c++)
+            a[J][c] -= factor * a[K][c];
+        update_rows<K, J + 1, N>::run(a, T{}, std::true_type{});
+    }
+    template <typename T>
+    static void run(rows_t<T, N> &a, const T &prev_pivot, std::false_type) {
+        for (size_t c = K + 1; c < N; c++)
+            a[J][c] = (a[J][c] * a[K][K] - a[J][K] * a[K][c]) / prev_pivot;
+        update_rows<K, J + 1, N>::run(a, prev_pivot, std::false_type{});
+    }
+};
+
+template <size_t K, size_t N>
+struct update_rows<K, N, N> {
+    template <typename T, typename Tag>
+    static void run(rows_t<T, N> &, const T &, Tag) {}
+};
+
+template <size_t K, size_t N>
+struct elimination {
+    // returns false if the column has no pivot, the determinant is 0 then
+    template <typename T, typename Tag>
+    static bool run(rows_t<T, N> &a, bool &negative, const T &prev_pivot, Tag tag) {
+        using std::abs;
+        size_t pivot = K;
+        for (size_t r = K + 1; r < N; r++)
+            if (Tag::value ? abs(a[r][K]) > abs(a[pivot][K]) : a[pivot][K] == T{})
+                pivot = r;
+        if (a[pivot][K] == T{})
+            return false;
+        if (pivot != K) {
+            std::swap(a[pivot], a[K]);
+            negative = !negative;
+        }
+        update_rows<K, K + 1, N>::run(a, prev_pivot, tag);
+        return elimination<K + 1, N>::run(a, negative, a[K][K], tag);
+    }
+};
+
+template <size_t N>
+struct elimination<N, N> {
+    template <typename T, typename Tag>
+    static bool run(rows_t<T, N> &, bool &, const T &, Tag) {
+        return true;
+    }
+};
+
+} // namespace fixed
+
+// closed forms up to 4 x 4, usable in constant expressions
+template <typename T>
+constexpr T det_fixed(const FixedMatrix<T, 1, 1> &mat) {
+    return mat[0][0];
+}
+
+template <typename T>
+constexpr T det_fixed(const FixedMatrix<T, 2, 2> &mat) {
+    return fixed::minor2(mat.data, 0, 1, 0, 1);
+}
+
+template <typename T>
+constexpr T det_fixed(const FixedMatrix<T, 3, 3> &mat) {
+    return mat[0][0] * fixed::minor2(mat.data, 1, 2, 1, 2) - mat[0][1] * fixed::minor2(mat.data, 1, 2, 0, 2) +
+           mat[0][2] * fixed::minor2(mat.data, 1, 2, 0, 1);
+}
+
+// Laplace expansion along the first two rows: six 2 x 2 minors of the top
+// rows times the complementary minors of the bottom ones
+template <typename T>
+constexpr T det_fixed(const FixedMatrix<T, 4, 4> &mat) {
+    return fixed::minor2(mat.data, 0, 1, 0, 1) * fixed::minor2(mat.data, 2, 3, 2, 3) -
+           fixed::minor2(mat.data, 0, 1, 0, 2) * fixed::minor2(mat.data, 2, 3, 1, 3) +
+           fixed::minor2(mat.data, 0, 1, 0, 3) * fixed::minor2(mat.data, 2, 3, 1, 2) +
+           fixed::minor2(mat.data, 0, 1, 1, 2) * fixed::minor2(mat.data, 2, 3, 0, 3) -
+           fixed::minor2(mat.data, 0, 1, 1, 3) * fixed::minor2(mat.data, 2, 3, 0, 2) +
+           fixed::minor2(mat.data, 0, 1, 2, 3) * fixed::minor2(mat.data, 2, 3, 0, 1);
+}
+
+template <typename T, size_t N>
+typename std::enable_if<(N > 4), T>::type det_fixed(FixedMatrix<T, N, N> mat) {
+    using floating = std::integral_constant<bool, std::is_floating_point<T>::value>;
+    bool negative = false;
+    if (!fixed::elimination<0, N>::run(mat.data, negative, T(1), floating{}))
+        return T{};
+    if (!floating::value)
+        return negative ? T(-mat[N - 1][N - 1]) : mat[N - 1][N - 1];
+    T res = negative ? T(-1) : T(1);
+    for (size_t i = 0; i < N; i++)
+        res *= mat[i][i];
+    return res;
+}
+
+} // namespace Linagl
@@ -0,0 +1,147 @@
+#pragma once
+#include "simd.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// Packed matrix product for float and double in the Goto/BLIS layout: B is
+// packed in kc x nc slabs of NR wide column panels, A in mc x kc blocks of MR
+// tall row panels, and an MR x NR micro-kernel keeps its piece of C in
+// registers over the whole kc run. Panels are padded with zeros to full MR/NR,
+// so the kernel has no edge cases and only the write back to C is clipped.
+// Matrices are passed as tables of row pointers, which covers permuted rows.
+namespace Linagl {
+namespace gemm {
+
+// the A block stays in L2 and the B panel under one micro-kernel in L1
+enum : size_t { mc = 128, kc = 256, nc = 4096 };
+
+struct shape_t {
+    size_t mr;
+    size_t nr;
+};
+
+// row panels of rows i0 .. i0 + m, columns p0 .. p0 + k: panel-major, then column-major inside
+template <typename T>
+void pack_a(T *dst, const T *const *a, size_t i0, size_t m, size_t p0, size_t k, size_t mr) {
+    for (size_t i = 0; i < m; i += mr)
+        for (size_t p = 0; p < k; p++)
+            for (size_t r = 0; r < mr; r++)
+                *dst++ = i + r < m ? a[i0 + i + r][p0 + p] : T{};
+}
+
+// column panels of rows p0 .. p0 + k, columns j0 .. j0 + n: panel-major, then row-major inside
+template <typename T>
+void pack_b(T *dst, const T *const *b, size_t p0, size_t k, size_t j0, size_t n, size_t nr) {
+    for (size_t j = 0; j < n; j += nr)
+        for (size_t p = 0; p < k; p++) {
+            const T *row = b[p0 + p] + j0 + j;
+            for (size_t c = 0; c < nr; c++)
+                *dst++ = j + c < n ? row[c] : T{};
+        }
+}
+
+// C[i0 .. i0 + MR][j0 .. j0 + NR] += a * b over packed panels, clipped to m x n
+template <size_t MR, size_t NR, typename T>
+inline __attribute__((always_inline)) void micro_kernel(size_t k, const T *a, const T *b, T *const *c, size_t i0,
+                                                        size_t j0, size_t m, size_t n) {
+    T acc[MR][NR] = {};
+    for (size_t p = 0; p < k; p++, a += MR, b += NR)
+#pragma GCC unroll 16
+        for (size_t r = 0; r < MR; r++)
+#pragma GCC unroll 32
+            for (size_t jj = 0; jj < NR; jj++)
+                acc[r][jj] += a[r] * b[jj];
+    for (size_t r = 0; r < MR && r < m; r++)
+        for (size_t jj = 0; jj < NR && jj < n; jj++)
+            c[i0 + r][j0 + jj] += acc[r][jj];
+}
+
+template <size_t MR, size_t NR, typename T>
+inline __attribute__((always_inline)) void macro_kernel(size_t m, size_t n, size_t k, const T *a, const T *b,
+                                                        T *const *c, size_t i0, size_t j0) {
+    for (size_t j = 0; j < n; j += NR)
+        for (size_t i = 0; i < m; i += MR)
+            micro_kernel<MR, NR>(k, a + i * k, b + j * k, c, i0 + i, j0 + j, m - i, n - j);
+}
+
+#ifdef LINAGL_X86_DISPATCH
+LINAGL_TARGET("avx2,fma")
+inline void macro_avx2(size_t m, size_t n, size_t k, const double *a, const double *b, double *const *c, size_t i0,
+                       size_t j0) {
+    macro_kernel<4, 8>(m, n, k, a, b, c, i0, j0);
+}
+LINAGL_TARGET("avx2,fma")
+inline void macro_avx2(size_t m, size_t n, size_t k, const float *a, const float *b, float *const *c, size_t i0,
+                       size_t j0) {
+    macro_kernel<4, 16>(m, n, k, a, b, c, i0, j0);
+}
+LINAGL_TARGET("avx512f,prefer-vector-width=512")
+inline void macro_avx512(size_t m, size_t n, size_t k, const double *a, const double *b, double *const *c, size_t i0,
+                         size_t j0) {
+    macro_kernel<8, 16>(m, n, k, a, b, c, i0, j0);
+}
+LINAGL_TARGET("avx512f,prefer-vector-width=512")
+inline void macro_avx512(size_t m, size_t n, size_t k, const float *a, const float *b, float *const *c, size_t i0,
+                         size_t j0) {
+    macro_kernel<8, 32>(m, n, k, a, b, c, i0, j0);
+}
+#endif
+
+// micro-kernel shape of every ISA, must match the wrappers above
+template <typename T>
+shape_t kernel_shape(simd::isa_t isa) {
+    const size_t wide = sizeof(T) == sizeof(float) ? 2 : 1;
+    switch (isa) {
+    case simd::isa_t::avx512:
+        return {8, 16 * wide};
+    case simd::isa_t::avx2:
+        return {4, 8 * wide};
+    case simd::isa_t::scalar:
+        break;
+    }
+    return {4, 4};
+}
+
+template <typename T>
+void macro(simd::isa_t isa, size_t m, size_t n, size_t k, const T *a, const T *b, T *const *c, size_t i0, size_t j0) {
+#ifdef LINAGL_X86_DISPATCH
+    switch (isa) {
+    case simd::isa_t::avx512:
+        return macro_avx512(m, n, k, a, b, c, i0, j0);
+    case simd::isa_t::avx2:
+        return macro_avx2(m, n, k, a, b, c, i0, j0);
+    case simd::isa_t::scalar:
+        break;
+    }
+#endif
+    macro_kernel<4, 4>(m, n, k, a, b, c, i0, j0);
+}
+
+// c += a * b, a is m x k and b is k x n
+template <typename T>
+void multiply_add(size_t m, size_t n, size_t k, const T *const *a, const T *const *b, T *const *c) {
+    static_assert(std::is_floating_point<T>::value, "packed GEMM is for float and double");
+    const simd::isa_t isa = simd::active_isa();
+    const shape_t shape = kernel_shape<T>(isa);
+    const size_t n_max = std::min<size_t>(nc, n);
+
+    std::vector<T> a_pack(mc * kc);
+    std::vector<T> b_pack((n_max + shape.nr - 1) / shape.nr * shape.nr * kc);
+    for (size_t j0 = 0; j0 < n; j0 += nc) {
+        const size_t nb = std::min<size_t>(nc, n - j0);
+        for (size_t p0 = 0; p0 < k; p0 += kc) {
+            const size_t kb = std::min<size_t>(kc, k - p0);
+            pack_b(b_pack.data(), b, p0, kb, j0, nb, shape.nr);
+            for (size_t i0 = 0; i0 < m; i0 += mc) {
+                const size_t mb = std::min<size_t>(mc, m - i0);
+                pack_a(a_pack.data(), a, i0, mb, p0, kb, shape.mr);
+                macro(isa, mb, nb, kb, a_pack.data(), b_pack.data(), c, i0, j0);
+            }
+        }
+    }
+}
+
+} // namespace gemm
+} // namespace Linagl
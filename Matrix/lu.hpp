@@ -0,0 +1,137 @@
+#pragma once
+#include "Matrix.hpp"
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace Linagl {
+
+// PA = LU with partial pivoting, factored once and queried many times. The
+// factors are packed into one matrix: unit lower L below the diagonal, U on and
+// above it. Elimination goes column by column in row echelon order and takes
+// any nonzero pivot, so det(), solve() and inverse() agree with det_LUP and
+// only an exactly zero column makes the matrix singular. rank() also works for
+// singular and rectangular matrices; for inexact types it doesn't count pivots
+// below max(m, n) * eps * max|a_ij|.
+template <typename T>
+class LU {
+    static_assert(!std::is_integral<T>::value, "LU needs a field, use e.g. Number_ext for integer matrices");
+
+  public:
+    explicit LU(const Matrix<T> &mat)
+        : LU_(mat), Height_(mat.get_heigth()), Width_(mat.get_width()), perm_(Height_) {
+        using boost::abs;
+        using boost::multiprecision::abs;
+        using std::abs;
+        std::iota(perm_.begin(), perm_.end(), 0);
+
+        T tolerance{};
+        if (std::numeric_limits<T>::is_specialized && !std::numeric_limits<T>::is_exact) {
+            for (size_t i = 0; i < Height_; i++)
+                for (size_t j = 0; j < Width_; j++)
+                    if (abs(LU_[i][j]) > tolerance)
+                        tolerance = abs(LU_[i][j]);
+            tolerance *= T(std::max(Height_, Width_)) * std::numeric_limits<T>::epsilon();
+        }
+
+        auto &C = LU_;
+        for (size_t col = 0; col < Width_ && pivots_ < Height_; col++) {
+            const size_t r = pivots_;
+            size_t pivot = r;
+            for (size_t row = r + 1; row < Height_; row++)
+                if (abs(C[row][col]) > abs(C[pivot][col]))
+                    pivot = row;
+            if (C[pivot][col] == T{})
+                continue;
+
+            if (pivot != r) {
+                C.swap_row(pivot, r);
+                std::swap(perm_[pivot], perm_[r]);
+                negative_ = !negative_;
+            }
+            for (size_t j = r + 1; j < Height_; j++) {
+                C[j][col] /= C[r][col];
+                row_sub(&C[j][0] + col + 1, &C[r][0] + col + 1, C[j][col], Width_ - col - 1);
+            }
+            rank_ += abs(C[r][col]) > tolerance;
+            pivots_++;
+        }
+    }
+
+    size_t rank() const { return rank_; }
+    bool singular() const { return Height_ != Width_ || pivots_ < Height_; }
+
+    // row i of the factors is row permutation()[i] of the matrix
+    const Matrix<T> &factors() const { return LU_; }
+    const std::vector<size_t> &permutation() const { return perm_; }
+
+    T det() const {
+        if (Height_ != Width_)
+            throw std::invalid_argument("determinant of a non-square matrix");
+        if (singular())
+            return T{};
+        T res = negative_ ? T(-1) : T(1);
+        for (size_t i = 0; i < Height_; i++)
+            res *= LU_[i][i];
+        return res;
+    }
+
+    // X with AX = B for every column of B at O(n^2) per column
+    Matrix<T> solve(const Matrix<T> &B) const {
+        if (B.get_heigth() != Height_)
+            throw std::invalid_argument("right-hand side height doesn't match the matrix");
+        if (singular())
+            throw std::runtime_error("solve with a singular matrix");
+        const size_t N = Height_;
+        const size_t K = B.get_width();
+
+        Matrix<T> X(N, K);
+        for (size_t i = 0; i < N; i++)
+            for (size_t k = 0; k < K; k++)
+                X[i][k] = B[perm_[i]][k];
+        if (K == 0)
+            return X;
+
+        for (size_t i = 0; i < N; i++)
+            for (size_t p = 0; p < i; p++)
+                row_sub(&X[i][0], &X[p][0], LU_[i][p], K);
+        for (size_t i = N; i-- > 0;) {
+            for (size_t p = i + 1; p < N; p++)
+                row_sub(&X[i][0], &X[p][0], LU_[i][p], K);
+            for (size_t k = 0; k < K; k++)
+                X[i][k] /= LU_[i][i];
+        }
+        return X;
+    }
+
+    std::vector<T> solve(const std::vector<T> &b) const {
+        Matrix<T> B(b.size(), 1);
+        for (size_t i = 0; i < b.size(); i++)
+            B[i][0] = b[i];
+        auto X = solve(B);
+        std::vector<T> x(Height_);
+        for (size_t i = 0; i < Height_; i++)
+            x[i] = X[i][0];
+        return x;
+    }
+
+    Matrix<T> inverse() const {
+        Matrix<T> I(Height_, Height_);
+        for (size_t i = 0; i < Height_; i++)
+            I[i][i] = T(1);
+        return solve(I);
+    }
+
+  private:
+    Matrix<T> LU_;
+    size_t Height_;
+    size_t Width_;
+    std::vector<size_t> perm_;
+    // pivots_ counts the nonzero pivots, rank_ only those above the tolerance
+    size_t pivots_ = 0;
+    size_t rank_ = 0;
+    bool negative_ = false;
+};
+
+} // namespace Linagl
@@ -1,5 +1,16 @@
 #include "Matrix.hpp"
+#include "batch.hpp"
+#include "blocked_lu.hpp"
+#include "det_modular.hpp"
+#include "det_soa.hpp"
+#include "fixed.hpp"
+#include "lu.hpp"
+#include "parallel_lu.hpp"
+#include "sparse.hpp"
 #include <cassert>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
 
 void t_matrix() {
     size_t n_tests = 0, matrix_size = 0;
@@ -25,6 +36,652 @@ void t_matrix() {
     }
 }
 
+void t_det_integer() {
+    std::cout << "[ Bareiss vs rational LUP ]" << std::endl;
+    std::srand(42);
+    for (size_t size = 1; size <= 24; size++) {
+        Linagl::Matrix<int> mat{size, size};
+        for (size_t y = 0; y < size; y++)
+            for (size_t x = 0; x < size; x++)
+                mat[y][x] = std::rand() % 51 - 25;
+        // zero leading pivot and a singular case
+        mat[0][0] = 0;
+        if (size % 4 == 0)
+            for (size_t x = 0; x < size; x++)
+                mat[size - 1][x] = mat[0][x];
+
+        auto expected = Linagl::det_LUP(Linagl::Matrix<Linagl::Number_ext>{mat}).numerator();
+        if (mat.det_integer() == expected) {
+            std::cout << "Ok ";
+            continue;
+        }
+        std::cout << "\n[Failed]\n" << mat;
+        std::cout << "Evaluated det = " << mat.det_integer() << std::endl;
+        std::cout << "  Correct det = " << expected << std::endl;
+        break;
+    }
+    std::cout << std::endl;
+}
+
+void t_det_modular() {
+    std::cout << "[ Multi-modular vs Bareiss ]" << std::endl;
+    std::srand(7);
+    Linagl::thread_pool_t pool(4);
+    for (size_t size = 1; size <= 24; size++) {
+        Linagl::Matrix<int> mat{size, size};
+        for (size_t y = 0; y < size; y++)
+            for (size_t x = 0; x < size; x++)
+                mat[y][x] = size % 2 ? std::rand() % 51 - 25 : std::rand() - RAND_MAX / 2;
+        mat[0][0] = size % 3 ? mat[0][0] : INT_MIN;
+        if (size % 5 == 0)
+            for (size_t x = 0; x < size; x++)
+                mat[size - 1][x] = mat[0][x];
+
+        auto expected = mat.det_integer();
+        auto evaluated = Linagl::det_modular(mat, pool);
+        if (evaluated == expected) {
+            std::cout << "Ok ";
+            continue;
+        }
+        std::cout << "\n[Failed]\n" << mat;
+        std::cout << "Evaluated det = " << evaluated << std::endl;
+        std::cout << "  Correct det = " << expected << std::endl;
+        break;
+    }
+    std::cout << std::endl;
+}
+
+void t_det_real() {
+    std::cout << "[ Certified double vs multiprecision ]" << std::endl;
+    std::srand(11);
+    size_t n_certified = 0;
+    for (size_t size = 1; size <= 24; size++) {
+        Linagl::Matrix<double> mat{size, size};
+        for (size_t y = 0; y < size; y++)
+            for (size_t x = 0; x < size; x++)
+                mat[y][x] = size % 2 ? std::rand() % 51 - 25 : (std::rand() % 51 - 25) / 8.0;
+        if (size % 5 == 0)
+            for (size_t x = 0; x < size; x++)
+                mat[size - 1][x] = mat[0][x];
+
+        Linagl::Long_real fast;
+        n_certified += Linagl::det_certified(mat, 16, fast);
+        auto expected = Linagl::round_digits(mat.det_real(), 16);
+        auto evaluated = mat.det_real(16);
+        if (evaluated.str() == expected.str()) {
+            std::cout << "Ok ";
+            continue;
+        }
+        std::cout << "\n[Failed]\n" << mat;
+        std::cout << "Evaluated det = " << evaluated.str() << std::endl;
+        std::cout << "  Correct det = " << expected.str() << std::endl;
+        break;
+    }
+    std::cout << std::endl << n_certified << " certified" << std::endl;
+
+    // entries in quarters give determinants in multiples of 2^-16, exact at 16 decimal
+    // places, the double path must certify every one of them
+    bool ok = true;
+    for (size_t count = 0; count < 20; count++) {
+        const size_t size = 8;
+        Linagl::Matrix<double> mat{size, size};
+        for (size_t y = 0; y < size; y++)
+            for (size_t x = 0; x < size; x++)
+                mat[y][x] = (std::rand() % 17 - 8) / 4.0;
+        Linagl::Long_real fast;
+        ok &= Linagl::det_certified(mat, 16, fast) && fast == Linagl::round_digits(mat.det_real(), 16);
+    }
+    std::cout << (ok ? "Ok " : "[Failed] ") << std::endl;
+}
+
+void t_det_blocked() {
+    std::cout << "[ Blocked LU vs multiprecision ]" << std::endl;
+    std::srand(13);
+    for (size_t size = 1; size <= 70; size += 3) {
+        Linagl::Matrix<double> mat{size, size};
+        for (size_t y = 0; y < size; y++)
+            for (size_t x = 0; x < size; x++)
+                mat[y][x] = (std::rand() % 2001 - 1000) / 1000.0;
+
+        auto expected = mat.det_real();
+        auto evaluated = Linagl::det_blocked(mat, size % 24 + 1);
+        if (abs(evaluated - expected) < 1e-9 * abs(expected)) {
+            std::cout << "Ok ";
+            continue;
+        }
+        std::cout << "\n[Failed]\n" << mat;
+        std::cout << "Evaluated det = " << evaluated.str() << std::endl;
+        std::cout << "  Correct det = " << expected.str() << std::endl;
+        break;
+    }
+    std::cout << std::endl;
+}
+
+template <typename T>
+bool simd_matches_scalar() {
+    bool ok = true;
+    for (size_t n = 0; n < 70; n++)
+        for (size_t stride : {1, 3, 17}) {
+            std::vector<T> x(n * stride + 1), y(n + 1);
+            for (auto &v : x)
+                v = (std::rand() % 201 - 100) / 7.0;
+            for (auto &v : y)
+                v = (std::rand() % 201 - 100) / 3.0;
+            std::vector<T> expected = y;
+            Linagl::simd::scalar::axpy(expected.data(), x.data(), T(0.5), n);
+            size_t expected_max = Linagl::simd::scalar::iamax(x.data(), n, stride);
+
+            Linagl::simd::axpy(y.data(), x.data(), T(0.5), n);
+            for (size_t i = 0; i <= n; i++)
+                ok &= std::fabs(y[i] - expected[i]) < 1e-4;
+            ok &= n == 0 || Linagl::simd::iamax(x.data(), n, stride) == expected_max;
+        }
+    return ok;
+}
+
+void t_simd() {
+    using Linagl::simd::isa_t;
+    std::cout << "[ SIMD kernels vs scalar ]" << std::endl;
+    std::srand(17);
+    auto detected = Linagl::simd::active_isa();
+    for (auto isa : {isa_t::scalar, isa_t::avx2, isa_t::avx512}) {
+        if (Linagl::simd::set_isa(isa) != isa)
+            continue;
+        Linagl::Matrix<double> mat{100, 100};
+        for (size_t y = 0; y < 100; y++)
+            for (size_t x = 0; x < 100; x++)
+                mat[y][x] = (std::rand() % 2001 - 1000) / 1000.0;
+        auto expected = mat.det_real();
+        bool ok = simd_matches_scalar<double>() && simd_matches_scalar<float>();
+        ok &= abs(Linagl::det_blocked(mat, 16) - expected) < 1e-9 * abs(expected);
+        ok &= std::fabs(Linagl::det_LUP(mat) / expected.convert_to<double>() - 1) < 1e-9;
+        std::cout << (ok ? "Ok " : "[Failed] ");
+    }
+    Linagl::simd::set_isa(detected);
+    std::cout << std::endl;
+}
+
+void t_det_parallel() {
+    std::cout << "[ Parallel LU vs blocked LU ]" << std::endl;
+    std::srand(19);
+    Linagl::work_stealing_pool_t pool(4);
+    for (size_t size : {1, 15, 16, 47, 100, 201}) {
+        Linagl::Matrix<double> mat{size, size};
+        for (size_t y = 0; y < size; y++)
+            for (size_t x = 0; x < size; x++)
+                mat[y][x] = (std::rand() % 2001 - 1000) / 1000.0;
+
+        // same tiles, kernels and update order: the results are bitwise equal
+        auto expected = Linagl::det_blocked(mat, 16);
+        auto evaluated = Linagl::det_parallel(mat, pool, 16);
+        if (evaluated == expected) {
+            std::cout << "Ok ";
+            continue;
+        }
+        std::cout << "\n[Failed]\n";
+        std::cout << "Evaluated det = " << evaluated.str() << std::endl;
+        std::cout << "  Correct det = " << expected.str() << std::endl;
+        break;
+    }
+    std::cout << std::endl;
+}
+
+void t_lu() {
+    std::cout << "[ LU factorization object ]" << std::endl;
+    std::srand(23);
+    const size_t N = 30;
+    Linagl::Matrix<double> A{N, N}, B{N, 4};
+    for (size_t y = 0; y < N; y++) {
+        for (size_t x = 0; x < N; x++)
+            A[y][x] = (std::rand() % 2001 - 1000) / 1000.0;
+        for (size_t x = 0; x < 4; x++)
+            B[y][x] = std::rand() % 21 - 10;
+    }
+
+    Linagl::LU<double> lu(A);
+    auto expected = A.det_real().convert_to<double>();
+    bool ok = std::fabs(lu.det() / expected - 1) < 1e-9 && lu.rank() == N;
+
+    // residuals of AX = B and of A * A^-1 = I
+    auto X = lu.solve(B);
+    auto inv = lu.inverse();
+    double residual = 0;
+    for (size_t y = 0; y < N; y++)
+        for (size_t x = 0; x < N; x++) {
+            double ax = 0, ai = 0;
+            for (size_t k = 0; k < N; k++) {
+                ax += x < 4 ? A[y][k] * X[k][x] : 0;
+                ai += A[y][k] * inv[k][x];
+            }
+            residual = std::max(residual, x < 4 ? std::fabs(ax - B[y][x]) : 0);
+            residual = std::max(residual, std::fabs(ai - (x == y)));
+        }
+    ok &= residual < 1e-9;
+    std::cout << (ok ? "Ok " : "[Failed] ");
+
+    // exact inverse over rationals and rank of a rank deficient rectangular matrix
+    Linagl::Matrix<Linagl::Number_ext> R{5, 5};
+    for (size_t y = 0; y < 5; y++)
+        for (size_t x = 0; x < 5; x++)
+            R[y][x] = std::rand() % 11 - 5;
+    R[0][0] = 0;
+    Linagl::LU<Linagl::Number_ext> exact(R);
+    auto R_inv = exact.inverse();
+    ok = exact.det() == Linagl::det_LUP(R);
+    for (size_t y = 0; y < 5; y++)
+        for (size_t x = 0; x < 5; x++) {
+            Linagl::Number_ext sum = 0;
+            for (size_t k = 0; k < 5; k++)
+                sum += R[y][k] * R_inv[k][x];
+            ok &= sum == Linagl::Number_ext(x == y);
+        }
+    std::cout << (ok ? "Ok " : "[Failed] ");
+
+    Linagl::Matrix<double> D{4, 6};
+    for (size_t x = 0; x < 6; x++) {
+        D[1][x] = x + 1.0;
+        D[2][x] = x % 2 ? 0.1 : 0.7;
+        D[3][x] = 3 * D[1][x] - D[2][x] / 7;
+    }
+    ok = Linagl::LU<double>(D).rank() == 2 && Linagl::LU<double>(Linagl::Matrix<double>{3, 3}).rank() == 0;
+    std::cout << (ok ? "Ok " : "[Failed] ");
+
+    // a tiny pivot is below the rank tolerance, but the matrix is still regular
+    Linagl::Matrix<double> tiny{2, 2};
+    tiny[0][0] = 1;
+    tiny[1][1] = 1e-20;
+    Linagl::LU<double> tiny_lu(tiny);
+    auto x = tiny_lu.solve(std::vector<double>{1, 1e-20});
+    ok = tiny_lu.det() == Linagl::det_LUP(tiny) && tiny_lu.det() == 1e-20 && tiny_lu.rank() == 1;
+    ok &= !tiny_lu.singular() && x[0] == 1 && x[1] == 1;
+    std::cout << (ok ? "Ok " : "[Failed] ") << std::endl;
+}
+
+template <typename T, typename U>
+bool same_entries(const Linagl::Matrix<T> &lhs, const Linagl::Matrix<U> &rhs) {
+    if (lhs.get_heigth() != rhs.get_heigth() || lhs.get_width() != rhs.get_width())
+        return false;
+    for (size_t y = 0; y < lhs.get_heigth(); y++)
+        for (size_t x = 0; x < lhs.get_width(); x++)
+            if (lhs[y][x] != static_cast<T>(rhs[y][x]))
+                return false;
+    return true;
+}
+
+template <typename E, typename U, typename = typename std::enable_if<Linagl::is_expr<E>::value>::type>
+bool same_entries(const E &expr, const Linagl::Matrix<U> &rhs) {
+    return same_entries(Linagl::Matrix<typename E::value_type>(expr), rhs);
+}
+
+void t_multiply() {
+    using Linagl::simd::isa_t;
+    std::cout << "[ Matrix products ]" << std::endl;
+    std::srand(29);
+    auto detected = Linagl::simd::active_isa();
+    for (size_t size = 1; size <= 150; size += 13) {
+        // small integers keep every product exact in float and double too
+        const size_t M = size, K = size * 2 / 3 + 1, N = size % 7 + 40;
+        Linagl::Matrix<long long> A{M, K}, B{K, N}, expected{M, N};
+        for (size_t y = 0; y < M; y++)
+            for (size_t x = 0; x < K; x++)
+                A[y][x] = std::rand() % 19 - 9;
+        for (size_t y = 0; y < K; y++)
+            for (size_t x = 0; x < N; x++)
+                B[y][x] = std::rand() % 19 - 9;
+        for (size_t y = 0; y < M; y++)
+            for (size_t x = 0; x < N; x++)
+                for (size_t p = 0; p < K; p++)
+                    expected[y][x] += A[y][p] * B[p][x];
+
+        Linagl::Matrix<double> A_real(A), B_real(B);
+        bool ok = same_entries(A * B, expected) && same_entries(Linagl::multiply(A, B, 8), expected);
+        ok &= same_entries(Linagl::Matrix<Linagl::Long_number>(A) * Linagl::Matrix<Linagl::Long_number>(B), expected);
+        ok &= same_entries(Linagl::multiply(A_real, B_real, 8), expected);
+        ok &= same_entries(Linagl::Matrix<float>(A) * Linagl::Matrix<float>(B), expected);
+        for (auto isa : {isa_t::scalar, isa_t::avx2, isa_t::avx512})
+            if (Linagl::simd::set_isa(isa) == isa)
+                ok &= same_entries(A_real * B_real, expected);
+        Linagl::simd::set_isa(detected);
+        ok &= same_entries((A + A) - A, A) && same_entries(A - A, Linagl::Matrix<long long>{M, K});
+
+        if (ok) {
+            std::cout << "Ok ";
+            continue;
+        }
+        std::cout << "\n[Failed]\n" << M << "x" << K << " by " << K << "x" << N << std::endl;
+        break;
+    }
+    std::cout << std::endl;
+}
+
+template <typename T>
+bool expressions_match(size_t N) {
+    Linagl::Matrix<T> A{N, N}, B{N, N}, C{N, N}, D{N, N};
+    for (auto mat : {&A, &B, &C, &D})
+        for (size_t y = 0; y < N; y++)
+            for (size_t x = 0; x < N; x++)
+                (*mat)[y][x] = std::rand() % 19 - 9;
+    auto AB = Linagl::multiply(A, B);
+    Linagl::Matrix<T> expected{N, N};
+    for (size_t y = 0; y < N; y++)
+        for (size_t x = 0; x < N; x++)
+            expected[y][x] = AB[y][x] + C[y][x] - D[y][x];
+
+    Linagl::Matrix<T> R = A * B + C - D;
+    bool ok = same_entries(R, expected);
+    ok &= same_entries(C - D + A * B, expected);
+    ok &= same_entries((A + C) * B - C * B, AB);
+
+    // destinations that are operands too
+    Linagl::Matrix<T> X(A);
+    X = X * B;
+    ok &= same_entries(X, AB);
+    X = C;
+    X = A * B + X - D;
+    ok &= same_entries(X, expected);
+    X = D;
+    X = C - X + A * B;
+    ok &= same_entries(X, expected);
+    return ok;
+}
+
+void t_expressions() {
+    std::cout << "[ Lazy matrix expressions ]" << std::endl;
+    std::srand(31);
+    for (size_t size : {1, 7, 40, 97}) {
+        bool ok = expressions_match<double>(size) && expressions_match<long long>(size) &&
+                  expressions_match<Linagl::Long_number>(size);
+        std::cout << (ok ? "Ok " : "[Failed] ");
+    }
+    std::cout << std::endl;
+}
+
+void t_views() {
+    std::cout << "[ Strided views ]" << std::endl;
+    std::srand(37);
+    const size_t N = 9;
+    Linagl::Matrix<long long> mat{N, N};
+    for (size_t y = 0; y < N; y++)
+        for (size_t x = 0; x < N; x++)
+            mat[y][x] = std::rand() % 19 - 9;
+    const auto &cmat = mat;
+    auto early = cmat.view();
+    mat.swap_row(0, 5);
+    mat.swap_row(5, 7);
+    Linagl::Matrix<long long> copy(mat);
+
+    // views follow the row permutation, blocks and transposition are index games on it
+    auto view = cmat.view();
+    auto block = view.block(2, 1, 5, 5);
+    auto transposed = view.transposed();
+    bool ok = true;
+    for (size_t y = 0; y < N; y++)
+        for (size_t x = 0; x < N; x++) {
+            ok &= view(y, x) == copy[y][x] && early(y, x) == copy[y][x] && transposed[x][y] == copy[y][x];
+            ok &= y >= 5 || x >= 5 || block[y][x] == copy[y + 2][x + 1];
+        }
+    std::cout << (ok ? "Ok " : "[Failed] ");
+
+    // determinants of a block through converting views, no copy of the block is made beforehand
+    Linagl::Matrix<long long> block_copy = block;
+    ok = Linagl::det_LUP(block.as<Linagl::Number_ext>()).numerator() == block_copy.det_integer();
+    auto expected = block_copy.det_real();
+    ok &= abs(Linagl::det_blocked(block.as<double>(), 4) - expected) < 1e-9 * abs(expected);
+    ok &= abs(Linagl::det_blocked(transposed.as<double>()) - copy.det_real()) < 1e-9 * abs(copy.det_real());
+    std::cout << (ok ? "Ok " : "[Failed] ");
+
+    // writes through a mutable view and a transposition assigned onto its own matrix
+    mat.view().block(3, 3, 2, 2).transposed()(1, 0) = 100;
+    ok = mat[3][4] == 100;
+    mat = mat.view().transposed();
+    ok &= mat[4][3] == 100 && mat[1][2] == copy[2][1];
+    Linagl::Matrix<long long> sum = mat.view() + copy.view().transposed();
+    ok &= sum[8][0] == 2 * copy[0][8];
+    std::cout << (ok ? "Ok " : "[Failed] ") << std::endl;
+}
+
+void t_sparse() {
+    std::cout << "[ Sparse LU vs dense ]" << std::endl;
+    std::srand(41);
+    for (size_t size = 1; size <= 80; size += 8) {
+        // a few entries per row, every third matrix has a zero diagonal
+        Linagl::Matrix<long long> mat{size, size};
+        for (size_t y = 0; y < size; y++) {
+            mat[y][size % 3 == 0 ? size - 1 - y : y] = std::rand() % 9 + 1;
+            for (int k = 0; k < 2; k++)
+                mat[y][std::rand() % size] = std::rand() % 19 - 9;
+        }
+        if (size % 5 == 0)
+            for (size_t x = 0; x < size; x++)
+                mat[size - 1][x] = mat[0][x];
+
+        auto exact = Linagl::det_sparse(Linagl::SparseMatrix<Linagl::Number_ext>(mat));
+        auto real = Linagl::det_sparse(Linagl::SparseMatrix<double>(mat));
+        auto expected = mat.det_integer();
+        bool ok = exact == Linagl::Number_ext(expected) &&
+                  abs(real - Linagl::Long_real(expected)) <= 1e-9 * abs(Linagl::Long_real(expected));
+        if (ok) {
+            std::cout << "Ok ";
+            continue;
+        }
+        std::cout << "\n[Failed]\n" << mat;
+        std::cout << "Evaluated det = " << exact << " / " << real.str() << std::endl;
+        std::cout << "  Correct det = " << expected << std::endl;
+        break;
+    }
+    std::cout << std::endl;
+
+    // triplets are summed and zeros dropped, CSC is the same matrix
+    using entry_t = Linagl::SparseMatrix<int>::entry_t;
+    Linagl::SparseMatrix<int> small(3, 4, {{2, 1, 5}, {0, 3, 1}, {2, 1, -5}, {1, 0, 2}, {0, 3, 2}, {1, 2, 7}});
+    auto columns = small.columns();
+    bool ok = small.non_zeros() == 3 && small(0, 3) == 3 && small(2, 1) == 0 && small(1, 2) == 7;
+    ok &= columns.starts == std::vector<size_t>({0, 1, 1, 2, 3}) && columns.index == std::vector<size_t>({1, 1, 0});
+    ok &= same_entries(small.dense(), Linagl::Matrix<int>(Linagl::SparseMatrix<int>(small.dense()).dense()));
+    std::cout << (ok ? "Ok " : "[Failed] ");
+
+    // 2D Laplacian on a 30 x 30 grid: the fill stays far below the dense n^2
+    const size_t side = 30, N = side * side;
+    std::vector<entry_t> entries;
+    for (size_t v = 0; v < N; v++) {
+        entries.push_back({v, v, 4});
+        if (v % side != 0)
+            entries.push_back({v, v - 1, -1});
+        if (v % side != side - 1)
+            entries.push_back({v, v + 1, -1});
+        if (v >= side)
+            entries.push_back({v, v - side, -1});
+        if (v + side < N)
+            entries.push_back({v, v + side, -1});
+    }
+    std::vector<Linagl::SparseMatrix<double>::entry_t> real_entries;
+    for (const auto &e : entries)
+        real_entries.push_back({e.row, e.col, static_cast<double>(e.value)});
+    Linagl::SparseMatrix<double> grid(N, N, real_entries);
+    Linagl::SparseLU<double> lu(grid);
+    auto expected = Linagl::det_blocked(grid.dense());
+    ok = lu.non_zeros() < N * N / 10 && abs(lu.det() - expected) < 1e-9 * abs(expected);
+    std::cout << (ok ? "Ok " : "[Failed] ") << std::endl;
+}
+
+void t_det_structured() {
+    using kind_t = Linagl::structure_kind_t;
+    std::cout << "[ Structured determinants vs dense ]" << std::endl;
+    std::srand(43);
+    const size_t N = 40;
+    // entries allowed by the pattern: j - i in [-lower, upper], and inside blocks of 13 for the block diagonal case
+    struct pattern_t {
+        kind_t kind;
+        size_t lower;
+        size_t upper;
+    };
+    for (auto pattern : {pattern_t{kind_t::diagonal, 0, 0}, pattern_t{kind_t::lower_triangular, N, 0},
+                         pattern_t{kind_t::upper_triangular, 0, N}, pattern_t{kind_t::tridiagonal, 1, 1},
+                         pattern_t{kind_t::banded, 2, 3}, pattern_t{kind_t::banded, 4, 1},
+                         pattern_t{kind_t::block_diagonal, N, N}, pattern_t{kind_t::dense, N, N}}) {
+        Linagl::Matrix<long long> mat{N, N};
+        for (size_t y = 0; y < N; y++)
+            for (size_t x = 0; x < N; x++) {
+                bool inside = y <= x + pattern.lower && x <= y + pattern.upper;
+                if (pattern.kind == kind_t::block_diagonal)
+                    inside = y / 13 == x / 13;
+                // zero diagonal entries make the band elimination pivot
+                if (inside && (x != y || std::rand() % 4 != 0))
+                    mat[y][x] = std::rand() % 19 - 9;
+            }
+
+        auto shape = Linagl::analyze_structure(mat.view());
+        auto expected = Linagl::det_Bareiss(Linagl::Matrix<Linagl::Long_number>(mat));
+        auto expected_real = Linagl::det_LUP(Linagl::Matrix<Linagl::Long_real>(mat));
+        auto evaluated = mat.det_integer();
+        bool ok = shape.kind == pattern.kind && evaluated == expected;
+        ok &= abs(mat.det_real() - expected_real) <= 1e-30 * abs(expected_real);
+        ok &= pattern.kind != kind_t::block_diagonal || shape.blocks == std::vector<size_t>({0, 13, 26, 39});
+        if (ok) {
+            std::cout << "Ok ";
+            continue;
+        }
+        std::cout << "\n[Failed]\n" << mat;
+        std::cout << "Evaluated det = " << evaluated << std::endl;
+        std::cout << "  Correct det = " << expected << std::endl;
+        break;
+    }
+
+    // swapped rows of a const matrix are followed through operator[]: a tridiagonal
+    // matrix with its first two rows swapped is banded with lower 1 and upper 2
+    Linagl::Matrix<long long> band{N, N};
+    for (size_t y = 0; y < N; y++)
+        for (size_t x = y ? y - 1 : 0; x < N && x <= y + 1; x++)
+            band[y][x] = std::rand() % 19 - 9;
+    band.swap_row(0, 1);
+    const auto &cband = band;
+    auto shape = Linagl::analyze_structure(Linagl::matrix_window<long long>(cband, 0, 0, N, N));
+    auto expected = Linagl::det_Bareiss(Linagl::Matrix<Linagl::Long_number>(cband));
+    auto expected_real = Linagl::Long_real(expected);
+    bool ok = shape.kind == kind_t::banded && shape.lower == 1 && shape.upper == 2 && cband.det_integer() == expected;
+    ok &= abs(cband.det_real() - expected_real) <= 1e-30 * abs(expected_real);
+    std::cout << (ok ? "Ok " : "[Failed] ") << std::endl;
+}
+
+void t_det_batch() {
+    std::cout << "[ Batch determinants ]" << std::endl;
+    std::srand(47);
+    for (size_t size : {1, 3, 6, 10}) {
+        const size_t count = 100 + size;
+        std::stringstream input;
+        std::string expected;
+        for (size_t k = 0; k < count; k++) {
+            Linagl::Matrix<long long> mat{size, size};
+            for (size_t y = 0; y < size; y++)
+                for (size_t x = 0; x < size; x++)
+                    mat[y][x] = std::rand() % 2001 - 1000;
+            input << mat;
+            expected += mat.det_integer().str() + "\n";
+        }
+
+        Linagl::thread_pool_t pool(3);
+        std::ostringstream output;
+        bool ok = Linagl::det_batch<long long>(input, output, count, size, pool, 7) == count;
+        ok &= output.str() == expected;
+        std::cout << (ok ? "Ok " : "[Failed] ");
+    }
+    std::cout << std::endl;
+}
+
+template <size_t N>
+bool fixed_matches_dynamic() {
+    auto mat = Linagl::FixedMatrix<Linagl::Long_number, N, N>{};
+    for (size_t y = 0; y < N; y++)
+        for (size_t x = 0; x < N; x++)
+            mat[y][x] = std::rand() % 201 - 100;
+    mat[N - 1][0] = 0;
+    mat[0][0] = 0;
+    bool ok = Linagl::det_fixed(mat) == mat.dynamic().det_integer();
+
+    auto real = Linagl::FixedMatrix<double, N, N>::from(mat.dynamic());
+    auto expected = mat.dynamic().det_real();
+    ok &= std::fabs(Linagl::det_fixed(real) - expected.template convert_to<double>()) <=
+          1e-9 * std::fabs(expected.template convert_to<double>());
+    return ok;
+}
+
+void t_fixed() {
+    std::cout << "[ Fixed size matrices ]" << std::endl;
+    std::srand(53);
+    constexpr Linagl::FixedMatrix<int, 3, 3> constant = {2, 0, 1, 1, 3, 2, 1, 1, 2};
+    constexpr Linagl::FixedMatrix<long long, 4, 4> pascal = {1, 1, 1, 1, 1, 2, 3, 4, 1, 3, 6, 10, 1, 4, 10, 20};
+    static_assert(Linagl::det_fixed(constant) == 6 && Linagl::det_fixed(pascal) == 1, "closed forms");
+    static_assert(sizeof(Linagl::FixedMatrix<double, 3, 3>) == 9 * sizeof(double), "storage is inline");
+
+    for (int round = 0; round < 10; round++) {
+        bool ok = fixed_matches_dynamic<1>() && fixed_matches_dynamic<2>() && fixed_matches_dynamic<3>() &&
+                  fixed_matches_dynamic<4>() && fixed_matches_dynamic<5>() && fixed_matches_dynamic<7>() &&
+                  fixed_matches_dynamic<10>();
+        std::cout << (ok ? "Ok " : "[Failed] ");
+    }
+    std::cout << std::endl;
+}
+
+template <typename T>
+bool soa_matches_exact(size_t size, double tolerance) {
+    const size_t count = 37;
+    std::vector<T> mats(count * size * size);
+    std::vector<Linagl::Long_number> expected(count);
+    std::vector<double> bound(count, 1);
+    for (size_t m = 0; m < count; m++) {
+        Linagl::Matrix<long long> mat{size, size};
+        for (size_t y = 0; y < size; y++)
+            for (size_t x = 0; x < size; x++)
+                // every fifth matrix has a zero column
+                mat[y][x] = m % 5 == 0 && x == m % size ? 0 : std::rand() % 19 - 9;
+        // Hadamard's bound, the rounding error is relative to it rather than to the determinant
+        for (size_t y = 0; y < size; y++) {
+            double norm = 0;
+            for (size_t x = 0; x < size; x++) {
+                mats[(m * size + y) * size + x] = T(mat[y][x]);
+                norm += double(mat[y][x]) * mat[y][x];
+            }
+            bound[m] *= std::sqrt(norm);
+        }
+        expected[m] = mat.det_integer();
+    }
+
+    std::vector<T> dets(count);
+    Linagl::det_soa(mats.data(), count, size, dets.data());
+    bool ok = true;
+    for (size_t m = 0; m < count; m++) {
+        const double error = std::fabs(dets[m] - expected[m].convert_to<double>());
+        ok &= m % 5 == 0 ? dets[m] == T{} : error <= tolerance * bound[m];
+    }
+    return ok;
+}
+
+void t_det_soa() {
+    using Linagl::simd::isa_t;
+    std::cout << "[ SoA batch determinants ]" << std::endl;
+    std::srand(59);
+    auto detected = Linagl::simd::active_isa();
+    for (auto isa : {isa_t::scalar, isa_t::avx2, isa_t::avx512}) {
+        if (Linagl::simd::set_isa(isa) != isa)
+            continue;
+        bool ok = true;
+        for (size_t size : {1, 2, 3, 4, 5, 8})
+            ok &= soa_matches_exact<double>(size, 1e-13) && soa_matches_exact<float>(size, 1e-5);
+
+        std::vector<Linagl::FixedMatrix<double, 4, 4>> fixed(21);
+        for (auto &mat : fixed)
+            for (size_t y = 0; y < 4; y++)
+                for (size_t x = 0; x < 4; x++)
+                    mat[y][x] = (std::rand() % 2001 - 1000) / 1000.0;
+        auto dets = Linagl::det_soa(fixed);
+        for (size_t m = 0; m < fixed.size(); m++)
+            ok &= std::fabs(dets[m] - Linagl::det_fixed(fixed[m])) < 1e-12;
+        std::cout << (ok ? "Ok " : "[Failed] ");
+    }
+    Linagl::simd::set_isa(detected);
+    std::cout << std::endl;
+}
+
 template <typename F>
 int try_wrapper(F action) {
     try {
@@ -136,6 +793,27 @@ void t_exceptions() {
         long_lived = std::move(mat);
         assert(long_lived[0][0] == 3 && long_lived[1][1] == 3);
     });
+
+    /*
+        4. Solving with a singular matrix
+    */
+    std::cout << "4. Solving with a singular matrix" << std::endl;
+    n_tests_with_ex += try_wrapper([]() {
+        Linagl::Matrix<double> mat(2, 2);
+        mat[0][0] = mat[0][1] = mat[1][0] = mat[1][1] = 1;
+        Linagl::LU<double> lu(mat);
+        assert(lu.det() == 0 && lu.rank() == 1);
+        lu.solve(std::vector<double>{1, 2});
+    });
+
+    /*
+        5. Multiplying matrices of mismatched sizes
+    */
+    std::cout << "5. Multiplying matrices of mismatched sizes" << std::endl;
+    n_tests_with_ex += try_wrapper([]() {
+        Linagl::Matrix<double> lhs(2, 3), rhs(2, 3);
+        auto product = lhs * rhs;
+    });
     std::cout << "[ End exception testing ]" << std::endl;
 }
 
@@ -148,6 +826,22 @@ void eval_det_int() {
     std::cout << mat.det_integer() << std::endl;
 }
 
+// first line: number of matrices and their size, then the matrices; the
+// determinants go to stdout in input order and the throughput to stderr
+void eval_det_batch() {
+    std::ios::sync_with_stdio(false);
+    size_t n_matrices = 0, matrix_size = 0;
+    std::cin >> n_matrices >> matrix_size;
+
+    Linagl::thread_pool_t pool;
+    auto start = std::chrono::steady_clock::now();
+    size_t done = Linagl::det_batch<long long>(std::cin, std::cout, n_matrices, matrix_size, pool);
+    std::cout.flush();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << done << " matrices in " << seconds << " s, " << done / std::max(seconds, 1e-9) << " matrices/s"
+              << std::endl;
+}
+
 void eval_det_real() {
     size_t matrix_size;
     std::cin >> matrix_size;
@@ -155,21 +849,33 @@ void eval_det_real() {
     Linagl::Matrix<double> mat{matrix_size, matrix_size};
     std::cin >> mat;
 
-    auto det = mat.det_real();
-    auto ten_pow = Linagl::Long_real(10);
-    for (int i = 0; i < 4; i++)
-        ten_pow *= ten_pow;
-
-    det = boost::multiprecision::round(det * ten_pow) / ten_pow;
+    auto det = mat.det_real(16);
     std::cout << det.str() << std::endl;
 }
 
 int main() {
     try {
-#ifndef TEST
+#if defined(BATCH)
+        eval_det_batch();
+#elif !defined(TEST)
         eval_det_real();
 #else
         t_exceptions();
+        t_det_integer();
+        t_det_modular();
+        t_det_real();
+        t_det_blocked();
+        t_simd();
+        t_det_parallel();
+        t_lu();
+        t_multiply();
+        t_expressions();
+        t_views();
+        t_sparse();
+        t_det_structured();
+        t_det_batch();
+        t_fixed();
+        t_det_soa();
         t_matrix();
 #endif
     } catch (const std::exception &e) {
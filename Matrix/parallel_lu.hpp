@@ -0,0 +1,128 @@
+#pragma once
+#include "blocked_lu.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+namespace Linagl {
+
+// Tiled LU as a task graph on a work-stealing pool, with the same kernels and
+// per-tile update order as lu_blocked, so the factors are bitwise identical:
+//  - panel(k) factors tile column k once all updates of step k - 1 reached it,
+//  - column(k, j) applies the swaps of panel k to tile column j and solves tile (k, j),
+//  - gemm(i, j, k) updates tile (i, j) and is released by column(k, j).
+// Each task counts its unfinished predecessors and the last one to finish
+// submits it, so the next panel starts while the rest of the trailing update
+// is still running. The swaps of later panels reach the L tiles at the end.
+template <typename T>
+struct lu_task_graph {
+    lu_task_graph(tiled_matrix<T> &A, std::vector<size_t> &pivots, work_stealing_pool_t &pool)
+        : A_(A), pivots_(pivots), pool_(pool), nt_(A.tiles()), panel_deps_(nt_), column_deps_(nt_ * nt_) {
+        for (size_t k = 0; k < nt_; k++) {
+            panel_deps_[k] = k == 0 ? 0 : static_cast<int>(nt_ - k);
+            for (size_t j = k + 1; j < nt_; j++)
+                column_deps_[k * nt_ + j] = 1 + (k == 0 ? 0 : static_cast<int>(nt_ - k));
+        }
+    }
+
+    void run() {
+        pivots_.assign(A_.padded_size(), 0);
+        if (nt_ == 0)
+            return;
+        spawn([this]() { panel(0); });
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this]() { return done_; });
+        }
+
+        const size_t b = A_.block();
+        for (size_t tj = 0; tj < nt_; tj++)
+            for (size_t r = (tj + 1) * b; r < A_.padded_size(); r++)
+                tiles::swap_rows(A_, tj, r, pivots_[r]);
+    }
+
+  private:
+    tiled_matrix<T> &A_;
+    std::vector<size_t> &pivots_;
+    work_stealing_pool_t &pool_;
+    size_t nt_;
+    std::vector<std::atomic<int>> panel_deps_;
+    std::vector<std::atomic<int>> column_deps_;
+    // tasks submitted and not finished yet; the last one signals under the lock,
+    // so nothing touches the graph once run() stops waiting
+    std::atomic<size_t> active_{0};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool done_ = false;
+
+    template <typename F>
+    void spawn(F task) {
+        active_++;
+        pool_.submit([this, task]() {
+            task();
+            if (--active_ == 0) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                done_ = true;
+                cv_.notify_one();
+            }
+        });
+    }
+
+    void panel(size_t k) {
+        tiles::panel(A_, k, pivots_);
+        for (size_t j = k + 1; j < nt_; j++)
+            release_column(k, j);
+    }
+
+    void column(size_t k, size_t j) {
+        const size_t b = A_.block();
+        for (size_t r = k * b; r < (k + 1) * b; r++)
+            tiles::swap_rows(A_, j, r, pivots_[r]);
+        tiles::trsm(A_.tile(k, j), A_.tile(k, k), b);
+        for (size_t i = k + 1; i < nt_; i++)
+            spawn([this, i, j, k]() { gemm(i, j, k); });
+    }
+
+    void gemm(size_t i, size_t j, size_t k) {
+        tiles::gemm(A_.tile(i, j), A_.tile(i, k), A_.tile(k, j), A_.block());
+        if (j == k + 1) {
+            if (--panel_deps_[k + 1] == 0)
+                spawn([this, k]() { panel(k + 1); });
+        } else {
+            release_column(k + 1, j);
+        }
+    }
+
+    void release_column(size_t k, size_t j) {
+        if (--column_deps_[k * nt_ + j] == 0)
+            spawn([this, k, j]() { column(k, j); });
+    }
+};
+
+template <typename T>
+void lu_parallel(tiled_matrix<T> &A, std::vector<size_t> &pivots, work_stealing_pool_t &pool) {
+    static_assert(std::is_floating_point<T>::value, "parallel LU is for float and double");
+    lu_task_graph<T> graph(A, pivots, pool);
+    graph.run();
+}
+
+template <typename T>
+Long_real det_parallel(const Matrix<T> &mat, work_stealing_pool_t &pool, size_t block = 48) {
+    if (mat.get_width() != mat.get_heigth())
+        return Long_real{};
+    tiled_matrix<T> A(mat, block);
+    std::vector<size_t> pivots;
+    lu_parallel(A, pivots, pool);
+    return det_factored(A, pivots);
+}
+
+// 0 threads means one per hardware thread
+template <typename T>
+Long_real det_parallel(const Matrix<T> &mat, size_t n_threads = 0, size_t block = 48) {
+    work_stealing_pool_t pool(n_threads);
+    return det_parallel(mat, pool, block);
+}
+
+} // namespace Linagl
@@ -0,0 +1,295 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LINAGL_X86_DISPATCH
+// the "undefined" placeholders of the AVX-512 intrinsics are self-initialized on purpose
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#define LINAGL_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+// Row kernels of the eliminations for float and double. Every kernel has a
+// scalar version and, on x86 with gcc/clang, AVX2+FMA and AVX-512 versions
+// compiled through target attributes; the widest one the CPU supports is picked
+// at runtime, so the binary itself needs no -m flags.
+namespace Linagl {
+namespace simd {
+
+enum class isa_t { scalar, avx2, avx512 };
+
+inline isa_t detect_isa() {
+#ifdef LINAGL_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return isa_t::avx512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return isa_t::avx2;
+#endif
+    return isa_t::scalar;
+}
+
+inline isa_t &active_isa_ref() {
+    static isa_t isa = detect_isa();
+    return isa;
+}
+
+inline isa_t active_isa() { return active_isa_ref(); }
+
+// restricts dispatch to `isa` if the CPU has it, returns the ISA in use
+inline isa_t set_isa(isa_t isa) {
+    if (isa <= detect_isa())
+        active_isa_ref() = isa;
+    return active_isa();
+}
+
+namespace scalar {
+
+template <typename T>
+void axpy(T *y, const T *x, T alpha, size_t n) {
+    for (size_t i = 0; i < n; i++)
+        y[i] += alpha * x[i];
+}
+
+template <typename T>
+size_t iamax(const T *x, size_t n, size_t stride) {
+    size_t best = 0;
+    for (size_t i = 1; i < n; i++)
+        if (std::fabs(x[i * stride]) > std::fabs(x[best * stride]))
+            best = i;
+    return best;
+}
+
+// The vector iamax kernels track the best value and its index in every lane
+// with compare and blend. A lane only moves to strictly larger values, so it
+// keeps its first maximum; here the smallest index among equal lanes wins and
+// the elements i .. n left over by the vector loop are scanned.
+template <typename T, typename I>
+size_t reduce_iamax(const T *best, const I *pos, size_t lanes, const T *x, size_t i, size_t n, size_t stride) {
+    T max = -1;
+    size_t res = 0;
+    for (size_t l = 0; l < lanes; l++)
+        if (best[l] > max || (best[l] == max && static_cast<size_t>(pos[l]) < res)) {
+            max = best[l];
+            res = static_cast<size_t>(pos[l]);
+        }
+    for (; i < n; i++)
+        if (std::fabs(x[i * stride]) > max) {
+            max = std::fabs(x[i * stride]);
+            res = i;
+        }
+    return res;
+}
+
+} // namespace scalar
+
+#ifdef LINAGL_X86_DISPATCH
+namespace avx2 {
+
+LINAGL_TARGET("avx2,fma") inline void axpy(double *y, const double *x, double alpha, size_t n) {
+    const __m256d a = _mm256_set1_pd(alpha);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d y0 = _mm256_fmadd_pd(a, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i));
+        __m256d y1 = _mm256_fmadd_pd(a, _mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4));
+        _mm256_storeu_pd(y + i, y0);
+        _mm256_storeu_pd(y + i + 4, y1);
+    }
+    for (; i < n; i++)
+        y[i] += alpha * x[i];
+}
+
+LINAGL_TARGET("avx2,fma") inline void axpy(float *y, const float *x, float alpha, size_t n) {
+    const __m256 a = _mm256_set1_ps(alpha);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 y0 = _mm256_fmadd_ps(a, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i));
+        __m256 y1 = _mm256_fmadd_ps(a, _mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8));
+        _mm256_storeu_ps(y + i, y0);
+        _mm256_storeu_ps(y + i + 8, y1);
+    }
+    for (; i < n; i++)
+        y[i] += alpha * x[i];
+}
+
+LINAGL_TARGET("avx2,fma") inline size_t iamax(const double *x, size_t n, size_t stride) {
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m256i step = _mm256_set1_epi64x(static_cast<long long>(4 * stride));
+    const __m256i four = _mm256_set1_epi64x(4);
+    __m256i idx = _mm256_set_epi64x(3 * stride, 2 * stride, stride, 0);
+    __m256i pos = _mm256_set_epi64x(3, 2, 1, 0);
+    __m256d best = _mm256_set1_pd(-1);
+    __m256d best_pos = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4, idx = _mm256_add_epi64(idx, step), pos = _mm256_add_epi64(pos, four)) {
+        __m256d val = _mm256_andnot_pd(sign, _mm256_i64gather_pd(x, idx, 8));
+        __m256d gt = _mm256_cmp_pd(val, best, _CMP_GT_OQ);
+        best = _mm256_blendv_pd(best, val, gt);
+        best_pos = _mm256_blendv_pd(best_pos, _mm256_castsi256_pd(pos), gt);
+    }
+
+    double lanes[4];
+    long long lanes_pos[4];
+    _mm256_storeu_pd(lanes, best);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes_pos), _mm256_castpd_si256(best_pos));
+    return scalar::reduce_iamax(lanes, lanes_pos, 4, x, i, n, stride);
+}
+
+LINAGL_TARGET("avx2,fma") inline size_t iamax(const float *x, size_t n, size_t stride) {
+    if (n * stride > static_cast<size_t>(std::numeric_limits<int>::max()))
+        return scalar::iamax(x, n, stride);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const int s = static_cast<int>(stride);
+    const __m256i step = _mm256_set1_epi32(8 * s);
+    const __m256i eight = _mm256_set1_epi32(8);
+    __m256i idx = _mm256_set_epi32(7 * s, 6 * s, 5 * s, 4 * s, 3 * s, 2 * s, s, 0);
+    __m256i pos = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    __m256 best = _mm256_set1_ps(-1);
+    __m256 best_pos = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8, idx = _mm256_add_epi32(idx, step), pos = _mm256_add_epi32(pos, eight)) {
+        __m256 val = _mm256_andnot_ps(sign, _mm256_i32gather_ps(x, idx, 4));
+        __m256 gt = _mm256_cmp_ps(val, best, _CMP_GT_OQ);
+        best = _mm256_blendv_ps(best, val, gt);
+        best_pos = _mm256_blendv_ps(best_pos, _mm256_castsi256_ps(pos), gt);
+    }
+
+    float lanes[8];
+    int lanes_pos[8];
+    _mm256_storeu_ps(lanes, best);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes_pos), _mm256_castps_si256(best_pos));
+    return scalar::reduce_iamax(lanes, lanes_pos, 8, x, i, n, stride);
+}
+
+} // namespace avx2
+
+namespace avx512 {
+
+LINAGL_TARGET("avx512f") inline void axpy(double *y, const double *x, double alpha, size_t n) {
+    const __m512d a = _mm512_set1_pd(alpha);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(y + i, _mm512_fmadd_pd(a, _mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+    if (i < n) {
+        __mmask8 tail = static_cast<__mmask8>((1u << (n - i)) - 1);
+        __m512d res = _mm512_fmadd_pd(a, _mm512_maskz_loadu_pd(tail, x + i), _mm512_maskz_loadu_pd(tail, y + i));
+        _mm512_mask_storeu_pd(y + i, tail, res);
+    }
+}
+
+LINAGL_TARGET("avx512f") inline void axpy(float *y, const float *x, float alpha, size_t n) {
+    const __m512 a = _mm512_set1_ps(alpha);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_ps(y + i, _mm512_fmadd_ps(a, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+    if (i < n) {
+        __mmask16 tail = static_cast<__mmask16>((1u << (n - i)) - 1);
+        __m512 res = _mm512_fmadd_ps(a, _mm512_maskz_loadu_ps(tail, x + i), _mm512_maskz_loadu_ps(tail, y + i));
+        _mm512_mask_storeu_ps(y + i, tail, res);
+    }
+}
+
+LINAGL_TARGET("avx512f") inline size_t iamax(const double *x, size_t n, size_t stride) {
+    const __m512i step = _mm512_set1_epi64(static_cast<long long>(8 * stride));
+    const __m512i eight = _mm512_set1_epi64(8);
+    const long long s = static_cast<long long>(stride);
+    __m512i idx = _mm512_set_epi64(7 * s, 6 * s, 5 * s, 4 * s, 3 * s, 2 * s, s, 0);
+    __m512i pos = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+    __m512d best = _mm512_set1_pd(-1);
+    __m512i best_pos = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8, idx = _mm512_add_epi64(idx, step), pos = _mm512_add_epi64(pos, eight)) {
+        __m512d val = _mm512_abs_pd(_mm512_i64gather_pd(idx, x, 8));
+        __mmask8 gt = _mm512_cmp_pd_mask(val, best, _CMP_GT_OQ);
+        best = _mm512_mask_blend_pd(gt, best, val);
+        best_pos = _mm512_mask_blend_epi64(gt, best_pos, pos);
+    }
+
+    double lanes[8];
+    long long lanes_pos[8];
+    _mm512_storeu_pd(lanes, best);
+    _mm512_storeu_si512(lanes_pos, best_pos);
+    return scalar::reduce_iamax(lanes, lanes_pos, 8, x, i, n, stride);
+}
+
+LINAGL_TARGET("avx512f") inline size_t iamax(const float *x, size_t n, size_t stride) {
+    if (n * stride > static_cast<size_t>(std::numeric_limits<int>::max()))
+        return scalar::iamax(x, n, stride);
+    const int s = static_cast<int>(stride);
+    const __m512i step = _mm512_set1_epi32(16 * s);
+    const __m512i sixteen = _mm512_set1_epi32(16);
+    __m512i idx = _mm512_set_epi32(15 * s, 14 * s, 13 * s, 12 * s, 11 * s, 10 * s, 9 * s, 8 * s, 7 * s, 6 * s, 5 * s,
+                                   4 * s, 3 * s, 2 * s, s, 0);
+    __m512i pos = _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    __m512 best = _mm512_set1_ps(-1);
+    __m512i best_pos = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16, idx = _mm512_add_epi32(idx, step), pos = _mm512_add_epi32(pos, sixteen)) {
+        __m512 val = _mm512_abs_ps(_mm512_i32gather_ps(idx, x, 4));
+        __mmask16 gt = _mm512_cmp_ps_mask(val, best, _CMP_GT_OQ);
+        best = _mm512_mask_blend_ps(gt, best, val);
+        best_pos = _mm512_mask_blend_epi32(gt, best_pos, pos);
+    }
+
+    float lanes[16];
+    int lanes_pos[16];
+    _mm512_storeu_ps(lanes, best);
+    _mm512_storeu_si512(lanes_pos, best_pos);
+    return scalar::reduce_iamax(lanes, lanes_pos, 16, x, i, n, stride);
+}
+
+} // namespace avx512
+#endif
+
+namespace detail {
+
+template <typename T>
+void axpy(T *y, const T *x, T alpha, size_t n) {
+#ifdef LINAGL_X86_DISPATCH
+    switch (active_isa()) {
+    case isa_t::avx512:
+        return avx512::axpy(y, x, alpha, n);
+    case isa_t::avx2:
+        return avx2::axpy(y, x, alpha, n);
+    case isa_t::scalar:
+        break;
+    }
+#endif
+    scalar::axpy(y, x, alpha, n);
+}
+
+template <typename T>
+size_t iamax(const T *x, size_t n, size_t stride) {
+    if (n == 0)
+        return 0;
+#ifdef LINAGL_X86_DISPATCH
+    switch (active_isa()) {
+    case isa_t::avx512:
+        return avx512::iamax(x, n, stride);
+    case isa_t::avx2:
+        return avx2::iamax(x, n, stride);
+    case isa_t::scalar:
+        break;
+    }
+#endif
+    return scalar::iamax(x, n, stride);
+}
+
+} // namespace detail
+
+// y += alpha * x
+inline void axpy(double *y, const double *x, double alpha, size_t n) { detail::axpy(y, x, alpha, n); }
+inline void axpy(float *y, const float *x, float alpha, size_t n) { detail::axpy(y, x, alpha, n); }
+
+// index of the first element with the largest absolute value among x[0], x[stride], ...
+inline size_t iamax(const double *x, size_t n, size_t stride = 1) { return detail::iamax(x, n, stride); }
+inline size_t iamax(const float *x, size_t n, size_t stride = 1) { return detail::iamax(x, n, stride); }
+
+} // namespace simd
+} // namespace Linagl
@@ -0,0 +1,384 @@
+#pragma once
+#include "Matrix.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Linagl {
+
+// Compressed rows (CSR) or columns (CSC): line i holds the entries
+// index/values[starts[i] .. starts[i + 1]), sorted by index.
+template <typename T>
+struct compressed_t {
+    std::vector<size_t> starts;
+    std::vector<size_t> index;
+    std::vector<T> values;
+};
+
+// Sparse matrix kept in CSR, only the nonzero entries are stored.
+template <typename T>
+struct SparseMatrix {
+    struct entry_t {
+        size_t row;
+        size_t col;
+        T value;
+    };
+
+    // entries may come in any order, duplicates are summed and zeros dropped
+    SparseMatrix(size_t rows, size_t cols, std::vector<entry_t> entries) : Height_(rows), Width_(cols) {
+        for (const auto &e : entries)
+            if (e.row >= rows || e.col >= cols)
+                throw std::out_of_range("entry outside of the matrix");
+        std::sort(entries.begin(), entries.end(), [](const entry_t &lhs, const entry_t &rhs) {
+            return lhs.row != rhs.row ? lhs.row < rhs.row : lhs.col < rhs.col;
+        });
+
+        rows_.starts.assign(rows + 1, 0);
+        for (size_t k = 0; k < entries.size();) {
+            const size_t row = entries[k].row, col = entries[k].col;
+            T sum = entries[k].value;
+            for (k++; k < entries.size() && entries[k].row == row && entries[k].col == col; k++)
+                sum += entries[k].value;
+            if (sum == T{})
+                continue;
+            rows_.index.push_back(col);
+            rows_.values.push_back(sum);
+            rows_.starts[row + 1]++;
+        }
+        std::partial_sum(rows_.starts.begin(), rows_.starts.end(), rows_.starts.begin());
+    }
+
+    template <typename U>
+    explicit SparseMatrix(const Matrix<U> &mat) : Height_(mat.get_heigth()), Width_(mat.get_width()) {
+        rows_.starts.assign(Height_ + 1, 0);
+        for (size_t i = 0; i < Height_; i++) {
+            for (size_t j = 0; j < Width_; j++)
+                if (mat[i][j] != U{}) {
+                    rows_.index.push_back(j);
+                    rows_.values.push_back(static_cast<T>(mat[i][j]));
+                }
+            rows_.starts[i + 1] = rows_.index.size();
+        }
+    }
+
+    T operator()(size_t i, size_t j) const {
+        auto first = rows_.index.begin() + rows_.starts[i];
+        auto last = rows_.index.begin() + rows_.starts[i + 1];
+        auto it = std::lower_bound(first, last, j);
+        return it != last && *it == j ? rows_.values[it - rows_.index.begin()] : T{};
+    }
+
+    const compressed_t<T> &rows() const { return rows_; }
+
+    // the same entries in CSC
+    compressed_t<T> columns() const {
+        compressed_t<T> res;
+        res.starts.assign(Width_ + 1, 0);
+        for (size_t j : rows_.index)
+            res.starts[j + 1]++;
+        std::partial_sum(res.starts.begin(), res.starts.end(), res.starts.begin());
+        res.index.resize(rows_.index.size());
+        res.values.resize(rows_.values.size());
+        std::vector<size_t> next(res.starts.begin(), res.starts.end() - 1);
+        for (size_t i = 0; i < Height_; i++)
+            for (size_t p = rows_.starts[i]; p < rows_.starts[i + 1]; p++) {
+                size_t dst = next[rows_.index[p]]++;
+                res.index[dst] = i;
+                res.values[dst] = rows_.values[p];
+            }
+        return res;
+    }
+
+    Matrix<T> dense() const {
+        Matrix<T> res(Height_, Width_);
+        for (size_t i = 0; i < Height_; i++)
+            for (size_t p = rows_.starts[i]; p < rows_.starts[i + 1]; p++)
+                res[i][rows_.index[p]] = rows_.values[p];
+        return res;
+    }
+
+    size_t non_zeros() const { return rows_.index.size(); }
+    size_t get_width() const { return Width_; }
+    size_t get_heigth() const { return Height_; }
+
+  private:
+    size_t Height_;
+    size_t Width_;
+    compressed_t<T> rows_;
+};
+
+// Approximate minimum degree ordering (Amestoy, Davis, Duff) of the pattern of
+// A + A^T. Elimination runs on the quotient graph: an eliminated variable turns
+// into an element standing for the clique of its neighbours, and the degrees of
+// those neighbours are updated with AMD's bound on the external degree instead
+// of being counted exactly. Supervariables and mass elimination are left out.
+template <typename T>
+std::vector<size_t> amd_order(const SparseMatrix<T> &mat) {
+    if (mat.get_heigth() != mat.get_width())
+        throw std::invalid_argument("ordering of a non-square sparse matrix");
+    const size_t n = mat.get_heigth();
+    const auto &R = mat.rows();
+
+    // A[i] - variables adjacent to variable i, E[i] - elements adjacent to it,
+    // L[e] - variables of element e
+    std::vector<std::vector<size_t>> A(n), E(n), L(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t p = R.starts[i]; p < R.starts[i + 1]; p++)
+            if (R.index[p] != i) {
+                A[i].push_back(R.index[p]);
+                A[R.index[p]].push_back(i);
+            }
+
+    std::vector<size_t> degree(n);
+    std::set<std::pair<size_t, size_t>> queue;
+    for (size_t i = 0; i < n; i++) {
+        std::sort(A[i].begin(), A[i].end());
+        A[i].erase(std::unique(A[i].begin(), A[i].end()), A[i].end());
+        degree[i] = A[i].size();
+        queue.insert({degree[i], i});
+    }
+
+    std::vector<char> eliminated(n), absorbed(n);
+    std::vector<size_t> in_pivot(n, 0), w_stamp(n, 0), w(n);
+    std::vector<size_t> order;
+    for (size_t k = 0; k < n; k++) {
+        const size_t pivot = queue.begin()->second;
+        const size_t stamp = k + 1;
+        queue.erase(queue.begin());
+        eliminated[pivot] = 1;
+        order.push_back(pivot);
+
+        // the new element: neighbours of the pivot, directly or through its elements,
+        // which are absorbed into it
+        auto &Lp = L[pivot];
+        auto add = [&](size_t j) {
+            if (!eliminated[j] && in_pivot[j] != stamp) {
+                in_pivot[j] = stamp;
+                Lp.push_back(j);
+            }
+        };
+        for (size_t j : A[pivot])
+            add(j);
+        for (size_t e : E[pivot])
+            if (!absorbed[e]) {
+                for (size_t j : L[e])
+                    add(j);
+                absorbed[e] = 1;
+                L[e].clear();
+            }
+        A[pivot].clear();
+        E[pivot].clear();
+
+        // variables of Lp are now connected through the element, not directly
+        for (size_t i : Lp) {
+            auto &Ai = A[i];
+            Ai.erase(std::remove_if(Ai.begin(), Ai.end(),
+                                    [&](size_t j) { return eliminated[j] || in_pivot[j] == stamp; }),
+                     Ai.end());
+            auto &Ei = E[i];
+            Ei.erase(std::remove_if(Ei.begin(), Ei.end(), [&](size_t e) { return absorbed[e] != 0; }), Ei.end());
+            Ei.push_back(pivot);
+        }
+
+        // w[e] = |L[e] \ Lp| for every element next to Lp
+        for (size_t i : Lp)
+            for (size_t e : E[i])
+                if (e != pivot) {
+                    if (w_stamp[e] != stamp) {
+                        w_stamp[e] = stamp;
+                        w[e] = L[e].size();
+                    }
+                    w[e]--;
+                }
+
+        // approximate external degrees, elements inside Lp are absorbed as well
+        for (size_t i : Lp) {
+            size_t d = A[i].size() + Lp.size() - 1;
+            auto &Ei = E[i];
+            Ei.erase(std::remove_if(Ei.begin(), Ei.end(),
+                                    [&](size_t e) {
+                                        if (e == pivot)
+                                            return false;
+                                        if (absorbed[e] || w[e] == 0) {
+                                            absorbed[e] = 1;
+                                            return true;
+                                        }
+                                        d += w[e];
+                                        return false;
+                                    }),
+                     Ei.end());
+            d = std::min({d, degree[i] + Lp.size() - 1, n - k - 2});
+            queue.erase({degree[i], i});
+            degree[i] = d;
+            queue.insert({d, i});
+        }
+    }
+    return order;
+}
+
+// Left-looking sparse LU (Gilbert-Peierls) of A with columns taken in AMD order:
+// column k is a sparse triangular solve with the columns of L found so far,
+// visiting only the rows reachable from the pattern of A(:, q[k]) in the graph
+// of L, so the work is proportional to the arithmetic and not to n^2. Threshold
+// pivoting keeps the diagonal of the ordering, which AMD has chosen to keep the
+// fill low, as long as |a_qq| >= threshold * max |candidate|, and takes the
+// largest candidate otherwise. Exact types accept any nonzero diagonal.
+template <typename T>
+class SparseLU {
+  public:
+    using det_t = typename std::conditional<std::is_floating_point<T>::value, Long_real, T>::type;
+    enum : size_t { npos = static_cast<size_t>(-1) };
+
+    explicit SparseLU(const SparseMatrix<T> &mat, double threshold = 0.1)
+        : n_(mat.get_heigth()), q_(amd_order(mat)), pinv_(n_, npos) {
+        using boost::abs;
+        using boost::multiprecision::abs;
+        using std::abs;
+        const auto A = mat.columns();
+
+        std::vector<T> x(n_);
+        std::vector<char> visited(n_);
+        std::vector<size_t> reach;
+        L_.starts.push_back(0);
+        for (size_t k = 0; k < n_; k++) {
+            const size_t col = q_[k];
+            reach.clear();
+            for (size_t p = A.starts[col]; p < A.starts[col + 1]; p++)
+                if (!visited[A.index[p]])
+                    dfs(A.index[p], visited, reach);
+            for (size_t p = A.starts[col]; p < A.starts[col + 1]; p++)
+                x[A.index[p]] = A.values[p];
+
+            // reach holds a postorder, the columns of L are applied in reverse of it
+            for (size_t r = reach.size(); r-- > 0;) {
+                const size_t i = reach[r];
+                if (pinv_[i] == npos || x[i] == T{})
+                    continue;
+                const size_t s = pinv_[i];
+                for (size_t p = L_.starts[s]; p < L_.starts[s + 1]; p++)
+                    x[L_.index[p]] -= L_.values[p] * x[i];
+            }
+
+            size_t pivot = npos;
+            for (size_t i : reach)
+                if (pinv_[i] == npos && x[i] != T{}) {
+                    if (pivot == npos || (inexact::value && abs(x[i]) > abs(x[pivot])))
+                        pivot = i;
+                }
+            if (pivot == npos) {
+                singular_ = true;
+                return;
+            }
+            if (pinv_[col] == npos && x[col] != T{} && keeps_diagonal(x[col], x[pivot], threshold, inexact{}))
+                pivot = col;
+
+            const T diag = x[pivot];
+            pinv_[pivot] = k;
+            pivots_.push_back(diag);
+            for (size_t i : reach) {
+                if (pinv_[i] == npos && x[i] != T{}) {
+                    L_.index.push_back(i);
+                    L_.values.push_back(x[i] / diag);
+                } else if (i != pivot && x[i] != T{}) {
+                    u_non_zeros_++;
+                }
+                x[i] = T{};
+                visited[i] = 0;
+            }
+            L_.starts.push_back(L_.index.size());
+        }
+    }
+
+    bool singular() const { return singular_; }
+
+    det_t det() const {
+        if (singular_)
+            return det_t{};
+        det_t res = permutation_sign(pinv_) * permutation_sign(q_) > 0 ? det_t(1) : det_t(-1);
+        for (const T &d : pivots_)
+            res *= d;
+        return res;
+    }
+
+    // entries of L and U, diagonal included, to compare with the nonzeros of A
+    size_t non_zeros() const { return L_.index.size() + u_non_zeros_ + pivots_.size(); }
+    const std::vector<size_t> &column_order() const { return q_; }
+
+  private:
+    using inexact = std::integral_constant<bool, std::numeric_limits<T>::is_specialized &&
+                                                     !std::numeric_limits<T>::is_exact>;
+
+    size_t n_;
+    std::vector<size_t> q_;
+    // pinv_[i] is the step at which row i became the pivot
+    std::vector<size_t> pinv_;
+    // strictly lower part by columns, rows in the numbering of A
+    compressed_t<T> L_;
+    std::vector<T> pivots_;
+    size_t u_non_zeros_ = 0;
+    bool singular_ = false;
+
+    // iterative depth-first search from row `root` over the columns of L
+    void dfs(size_t root, std::vector<char> &visited, std::vector<size_t> &reach) const {
+        std::vector<std::pair<size_t, size_t>> stack{{root, 0}};
+        visited[root] = 1;
+        while (!stack.empty()) {
+            const size_t node = stack.back().first;
+            const size_t s = pinv_[node];
+            bool descended = false;
+            if (s != npos)
+                for (size_t &p = stack.back().second; L_.starts[s] + p < L_.starts[s + 1]; p++) {
+                    const size_t child = L_.index[L_.starts[s] + p];
+                    if (!visited[child]) {
+                        visited[child] = 1;
+                        p++;
+                        stack.push_back({child, 0});
+                        descended = true;
+                        break;
+                    }
+                }
+            if (!descended) {
+                reach.push_back(node);
+                stack.pop_back();
+            }
+        }
+    }
+
+    static bool keeps_diagonal(const T &diag, const T &max, double threshold, std::true_type) {
+        using boost::multiprecision::abs;
+        using std::abs;
+        return abs(diag) >= T(threshold) * abs(max);
+    }
+    static bool keeps_diagonal(const T &, const T &, double, std::false_type) { return true; }
+
+    static int permutation_sign(const std::vector<size_t> &perm) {
+        std::vector<char> seen(perm.size());
+        int sign = 1;
+        for (size_t i = 0; i < perm.size(); i++) {
+            if (seen[i])
+                continue;
+            size_t length = 0;
+            for (size_t j = i; !seen[j]; j = perm[j], length++)
+                seen[j] = 1;
+            if (length % 2 == 0)
+                sign = -sign;
+        }
+        return sign;
+    }
+};
+
+// determinant with memory and time driven by the nonzeros of the factors, 0 for non-square matrices
+template <typename T>
+typename SparseLU<T>::det_t det_sparse(const SparseMatrix<T> &mat, double threshold = 0.1) {
+    if (mat.get_heigth() != mat.get_width())
+        return typename SparseLU<T>::det_t{};
+    return SparseLU<T>(mat, threshold).det();
+}
+
+} // namespace Linagl
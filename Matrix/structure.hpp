@@ -0,0 +1,155 @@
+#pragma once
+#include "view.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Linagl {
+
+enum class structure_kind_t { diagonal, lower_triangular, upper_triangular, tridiagonal, block_diagonal, banded, dense };
+
+// nonzero pattern of a square matrix: a_ij == 0 whenever i - j > lower or
+// j - i > upper, and `blocks` are the first rows of the diagonal blocks
+struct structure_t {
+    structure_kind_t kind;
+    size_t lower;
+    size_t upper;
+    std::vector<size_t> blocks;
+};
+
+// One pass over the entries. Kinds are tried from the cheapest determinant on,
+// so a tridiagonal matrix with several blocks is still called tridiagonal.
+template <typename Mat>
+structure_t analyze_structure(const Mat &mat) {
+    using value_type = typename Mat::value_type;
+    const size_t n = mat.get_heigth();
+    structure_t res{structure_kind_t::dense, 0, 0, {}};
+
+    // reach[k] - the farthest row or column linked to k by a nonzero a_ij with min(i, j) = k
+    std::vector<size_t> reach(n);
+    for (size_t i = 0; i < n; i++) {
+        reach[i] = std::max(reach[i], i);
+        for (size_t j = 0; j < n; j++) {
+            if (mat[i][j] == value_type{})
+                continue;
+            if (i > j) {
+                res.lower = std::max(res.lower, i - j);
+                reach[j] = std::max(reach[j], i);
+            } else {
+                res.upper = std::max(res.upper, j - i);
+                reach[i] = std::max(reach[i], j);
+            }
+        }
+    }
+    for (size_t k = 0, end = 0; k < n; k++) {
+        if (k == 0 || k == end + 1)
+            res.blocks.push_back(k);
+        end = std::max(end, reach[k]);
+    }
+
+    if (res.lower == 0 && res.upper == 0)
+        res.kind = structure_kind_t::diagonal;
+    else if (res.upper == 0)
+        res.kind = structure_kind_t::lower_triangular;
+    else if (res.lower == 0)
+        res.kind = structure_kind_t::upper_triangular;
+    else if (res.lower == 1 && res.upper == 1)
+        res.kind = structure_kind_t::tridiagonal;
+    else if (res.blocks.size() > 1)
+        res.kind = structure_kind_t::block_diagonal;
+    else if (4 * (res.lower + res.upper) <= n)
+        res.kind = structure_kind_t::banded;
+    return res;
+}
+
+// f_k = a_k f_(k-1) - b_(k-1) c_(k-1) f_(k-2), the determinant of the leading k x k minor
+template <typename W, typename Mat>
+W det_tridiagonal(const Mat &mat) {
+    const size_t n = mat.get_heigth();
+    W prev = 1;
+    W cur = n == 0 ? W(1) : W(mat[0][0]);
+    for (size_t k = 1; k < n; k++) {
+        W next = W(mat[k][k]) * cur - W(mat[k - 1][k]) * W(mat[k][k - 1]) * prev;
+        prev = std::move(cur);
+        cur = std::move(next);
+    }
+    return cur;
+}
+
+// Gaussian elimination with partial pivoting inside the band. Row swaps widen
+// the upper band to lower + upper at most, so every row keeps a window of
+// columns [i - lower, i + lower + upper] around its current position i.
+template <typename W, typename Mat>
+W det_banded(const Mat &mat, size_t lower, size_t upper) {
+    using std::abs;
+    const size_t n = mat.get_heigth();
+    const size_t width = 2 * lower + upper + 1;
+    std::vector<W> band(n * width);
+    auto at = [&](size_t i, size_t col) -> W & { return band[i * width + col + lower - i]; };
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = i > lower ? i - lower : 0; j <= std::min(n - 1, i + upper); j++)
+            at(i, j) = W(mat[i][j]);
+
+    W det = 1;
+    for (size_t k = 0; k < n; k++) {
+        const size_t last_row = std::min(n - 1, k + lower);
+        const size_t last_col = std::min(n - 1, k + lower + upper);
+        size_t pivot = k;
+        for (size_t r = k + 1; r <= last_row; r++)
+            if (abs(at(r, k)) > abs(at(pivot, k)))
+                pivot = r;
+        if (at(pivot, k) == W{})
+            return W{};
+        if (pivot != k) {
+            for (size_t col = k; col <= last_col; col++)
+                std::swap(at(k, col), at(pivot, col));
+            det = -det;
+        }
+        det *= at(k, k);
+        for (size_t j = k + 1; j <= last_row; j++) {
+            if (at(j, k) == W{})
+                continue;
+            W factor = at(j, k) / at(k, k);
+            for (size_t col = k + 1; col <= last_col; col++)
+                at(j, col) -= factor * at(k, col);
+        }
+    }
+    return det;
+}
+
+// Determinant in arithmetic W by the algorithm that fits the structure; `dense`
+// gets the view of a block without structure and returns its determinant.
+template <typename W, typename Mat, typename Dense>
+W det_structured(const Mat &mat, const structure_t &shape, Dense dense) {
+    const size_t n = mat.get_heigth();
+    switch (shape.kind) {
+    case structure_kind_t::diagonal:
+    case structure_kind_t::lower_triangular:
+    case structure_kind_t::upper_triangular: {
+        W det = 1;
+        for (size_t i = 0; i < n; i++)
+            det *= W(mat[i][i]);
+        return det;
+    }
+    case structure_kind_t::tridiagonal:
+        return det_tridiagonal<W>(mat);
+    case structure_kind_t::block_diagonal: {
+        W det = 1;
+        for (size_t b = 0; b < shape.blocks.size(); b++) {
+            const size_t first = shape.blocks[b];
+            const size_t size = (b + 1 < shape.blocks.size() ? shape.blocks[b + 1] : n) - first;
+            det *= W(dense(mat.block(first, first, size, size)));
+        }
+        return det;
+    }
+    case structure_kind_t::banded:
+        return det_banded<W>(mat, shape.lower, shape.upper);
+    case structure_kind_t::dense:
+        break;
+    }
+    return W(dense(mat));
+}
+
+} // namespace Linagl
@@ -0,0 +1,182 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace Linagl {
+
+// Fixed set of worker threads taking tasks from a shared FIFO queue.
+class thread_pool_t {
+  public:
+    // 0 threads means one per hardware thread
+    explicit thread_pool_t(size_t n_threads = 0) {
+        if (n_threads == 0)
+            n_threads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < n_threads; i++)
+            workers_.emplace_back([this]() { work(); });
+    }
+
+    thread_pool_t(const thread_pool_t &) = delete;
+    thread_pool_t &operator=(const thread_pool_t &) = delete;
+
+    ~thread_pool_t() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto &w : workers_)
+            w.join();
+    }
+
+    template <typename F>
+    auto submit(F task) -> std::future<decltype(task())> {
+        using Res_t = decltype(task());
+        auto packed = std::make_shared<std::packaged_task<Res_t()>>(std::move(task));
+        auto res = packed->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace([packed]() { (*packed)(); });
+        }
+        cv_.notify_one();
+        return res;
+    }
+
+    size_t size() const { return workers_.size(); }
+
+  private:
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+
+    void work() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+                if (tasks_.empty())
+                    return;
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            task();
+        }
+    }
+};
+
+// Pool for task graphs whose tasks spawn their successors. Each worker owns a
+// deque: it pushes and pops its own tasks at the back (the freshest, still in
+// cache) and, when it runs dry, steals from the front of the others. Tasks
+// submitted from outside are spread over the workers round-robin.
+class work_stealing_pool_t {
+  public:
+    explicit work_stealing_pool_t(size_t n_threads = 0) {
+        if (n_threads == 0)
+            n_threads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < n_threads; i++)
+            queues_.emplace_back(new queue_t);
+        for (size_t i = 0; i < n_threads; i++)
+            workers_.emplace_back([this, i]() { work(i); });
+    }
+
+    work_stealing_pool_t(const work_stealing_pool_t &) = delete;
+    work_stealing_pool_t &operator=(const work_stealing_pool_t &) = delete;
+
+    ~work_stealing_pool_t() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto &w : workers_)
+            w.join();
+    }
+
+    void submit(std::function<void()> task) {
+        size_t idx = current_pool() == this ? current_worker() : next_++ % queues_.size();
+        // counted before it's published, so pending_ never drops below the number of
+        // queued tasks and a worker can't decrement it past zero
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            pending_++;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queues_[idx]->mutex);
+            queues_[idx]->tasks.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+    size_t size() const { return workers_.size(); }
+
+  private:
+    struct queue_t {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<queue_t>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_{0};
+    std::atomic<size_t> pending_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+
+    static const work_stealing_pool_t *&current_pool() {
+        static thread_local const work_stealing_pool_t *pool = nullptr;
+        return pool;
+    }
+    static size_t &current_worker() {
+        static thread_local size_t idx = 0;
+        return idx;
+    }
+
+    bool take(size_t idx, std::function<void()> &task) {
+        for (size_t i = 0; i < queues_.size(); i++) {
+            auto &q = *queues_[(idx + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.empty())
+                continue;
+            if (i == 0) {
+                task = std::move(q.tasks.back());
+                q.tasks.pop_back();
+            } else {
+                task = std::move(q.tasks.front());
+                q.tasks.pop_front();
+            }
+            pending_--;
+            return true;
+        }
+        return false;
+    }
+
+    void work(size_t idx) {
+        current_pool() = this;
+        current_worker() = idx;
+        for (;;) {
+            std::function<void()> task;
+            if (take(idx, task)) {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            cv_.wait(lock, [this]() { return stop_ || pending_ > 0; });
+            if (stop_ && pending_ == 0)
+                return;
+        }
+    }
+};
+
+} // namespace Linagl
@@ -0,0 +1,143 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+
+namespace Linagl {
+
+// Non-owning window over strided storage: element (i, j) lives at
+// data[row(i) * row_stride + col(j) * col_stride], where row and col are the
+// identity or look the index up in a table, e.g. the row permutation of a
+// matrix. Blocks, transposition and conversion only produce another view,
+// nothing is copied. ConstMatrixView<T, U> reads storage of U and hands out T,
+// converting every element lazily on access. A view doesn't keep its storage
+// or index tables alive.
+template <typename T, typename U = T>
+struct ConstMatrixView {
+    using value_type = T;
+    using reference = typename std::conditional<std::is_same<T, U>::value, const T &, T>::type;
+    static constexpr bool product_first = false;
+
+    struct row_t {
+      public:
+        row_t(const U *ptr, size_t stride, const size_t *index) : ptr_{ptr}, stride_{stride}, index_{index} {};
+        reference operator[](size_t idx) const {
+            return static_cast<reference>(ptr_[(index_ ? index_[idx] : idx) * stride_]);
+        }
+
+      private:
+        const U *ptr_;
+        size_t stride_;
+        const size_t *index_;
+    };
+
+    // `owner` is the matrix that holds the storage, if any, used to detect aliasing.
+    // Null index tables mean the identity.
+    ConstMatrixView(const U *data, size_t rows, size_t cols, size_t row_stride, size_t col_stride,
+                    const void *owner = nullptr, const size_t *row_index = nullptr,
+                    const size_t *col_index = nullptr)
+        : data_(data), Height_(rows), Width_(cols), row_stride_(row_stride), col_stride_(col_stride), owner_(owner),
+          row_index_(row_index), col_index_(col_index) {}
+
+    reference operator()(size_t i, size_t j) const {
+        return static_cast<reference>(data_[row_offset(i) + col_offset(j)]);
+    }
+    const row_t operator[](size_t idx) const { return row_t{data_ + row_offset(idx), col_stride_, col_index_}; }
+    reference at(size_t i, size_t j) const { return (*this)(i, j); }
+
+    // h x w block with its top left corner at (i0, j0)
+    ConstMatrixView block(size_t i0, size_t j0, size_t h, size_t w) const {
+        return {data_ + block_offset(i0, j0), h, w, row_stride_, col_stride_, owner_,
+                row_index_ ? row_index_ + i0 : nullptr, col_index_ ? col_index_ + j0 : nullptr};
+    }
+    ConstMatrixView transposed() const {
+        return {data_, Width_, Height_, col_stride_, row_stride_, owner_, col_index_, row_index_};
+    }
+    template <typename V>
+    ConstMatrixView<V, U> as() const {
+        return {data_, Height_, Width_, row_stride_, col_stride_, owner_, row_index_, col_index_};
+    }
+
+    size_t rows() const { return Height_; }
+    size_t cols() const { return Width_; }
+    size_t get_heigth() const { return Height_; }
+    size_t get_width() const { return Width_; }
+    size_t row_stride() const { return row_stride_; }
+    size_t col_stride() const { return col_stride_; }
+    const U *data() const { return data_; }
+    const size_t *row_index() const { return row_index_; }
+    const size_t *col_index() const { return col_index_; }
+
+    // the lazy expression interface, see matrix_ref in Matrix.hpp
+    template <typename Dst>
+    void assign_to(Dst &dst) const {
+        for (size_t i = 0; i < Height_; i++)
+            for (size_t j = 0; j < Width_; j++)
+                dst[i][j] = (*this)(i, j);
+    }
+    bool references(const void *p) const { return p != nullptr && p == owner_; }
+    bool aliased(const void *p) const { return references(p); }
+
+  protected:
+    const U *data_;
+    size_t Height_;
+    size_t Width_;
+    size_t row_stride_;
+    size_t col_stride_;
+    const void *owner_;
+    const size_t *row_index_;
+    const size_t *col_index_;
+
+    size_t row_offset(size_t i) const { return (row_index_ ? row_index_[i] : i) * row_stride_; }
+    size_t col_offset(size_t j) const { return (col_index_ ? col_index_[j] : j) * col_stride_; }
+    // a dimension with an index table keeps its offset in the table, not in data
+    size_t block_offset(size_t i0, size_t j0) const {
+        return (row_index_ ? 0 : i0 * row_stride_) + (col_index_ ? 0 : j0 * col_stride_);
+    }
+};
+
+template <typename T>
+struct MatrixView : ConstMatrixView<T> {
+    using ConstMatrixView<T>::data_;
+    using ConstMatrixView<T>::Height_;
+    using ConstMatrixView<T>::Width_;
+    using ConstMatrixView<T>::row_stride_;
+    using ConstMatrixView<T>::col_stride_;
+    using ConstMatrixView<T>::owner_;
+    using ConstMatrixView<T>::row_index_;
+    using ConstMatrixView<T>::col_index_;
+    using ConstMatrixView<T>::row_offset;
+    using ConstMatrixView<T>::col_offset;
+    using ConstMatrixView<T>::block_offset;
+
+  public:
+    struct row_t {
+      public:
+        row_t(T *ptr, size_t stride, const size_t *index) : ptr_{ptr}, stride_{stride}, index_{index} {};
+        T &operator[](size_t idx) const { return ptr_[(index_ ? index_[idx] : idx) * stride_]; }
+
+      private:
+        T *ptr_;
+        size_t stride_;
+        const size_t *index_;
+    };
+
+    MatrixView(T *data, size_t rows, size_t cols, size_t row_stride, size_t col_stride, const void *owner = nullptr,
+               const size_t *row_index = nullptr, const size_t *col_index = nullptr)
+        : ConstMatrixView<T>(data, rows, cols, row_stride, col_stride, owner, row_index, col_index) {}
+
+    T &operator()(size_t i, size_t j) const { return data()[row_offset(i) + col_offset(j)]; }
+    const row_t operator[](size_t idx) const { return row_t{data() + row_offset(idx), col_stride_, col_index_}; }
+
+    MatrixView block(size_t i0, size_t j0, size_t h, size_t w) const {
+        return {data() + block_offset(i0, j0), h, w, row_stride_, col_stride_, owner_,
+                row_index_ ? row_index_ + i0 : nullptr, col_index_ ? col_index_ + j0 : nullptr};
+    }
+    MatrixView transposed() const {
+        return {data(), Width_, Height_, col_stride_, row_stride_, owner_, col_index_, row_index_};
+    }
+
+    // the view was made from mutable storage, so the constness can be dropped safely
+    T *data() const { return const_cast<T *>(data_); }
+};
+
+} // namespace Linagl
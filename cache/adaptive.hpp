@@ -0,0 +1,118 @@
+#pragma once
+#include "cache.hpp"
+#include <functional>
+#include <map>
+
+namespace caches {
+
+enum class policy_t { lru, lfu };
+
+// Live cache that evicts either like LRU or like LFU. Two metadata-only shadow
+// caches replay a hash-sampled subset of the requests, the policy whose shadow
+// scored more hits over the last `window` sampled requests drives eviction.
+template <typename Key_t, typename Val_t> class adaptive_t {
+public:
+    adaptive_t(size_t size, size_t window = 0, size_t sample_rate = 1)
+        : size_(size), sample_rate_(std::max<size_t>(sample_rate, 1)),
+          shadow_lru_(std::max<size_t>(size / sample_rate_, 1)), shadow_lfu_(std::max<size_t>(size / sample_rate_, 1)),
+          window_(window ? window : 8 * std::max<size_t>(size, 1), 0) {}
+
+    template <typename F> bool look_update(Key_t key, F slow_path) {
+        if (sampled(key))
+            train(key);
+
+        auto hit = hash_.find(key);
+        if (hit != hash_.end()) {
+            touch(hit->first, hit->second);
+            return true;
+        }
+
+        if (hash_.size() >= size_)
+            evict();
+
+        Node_t node{std::move(slow_path(key)), 1, clock_++};
+        by_recency_[node.stamp] = key;
+        by_freq_[std::make_pair(node.freq, node.stamp)] = key;
+        hash_.emplace(key, std::move(node));
+        return false;
+    }
+
+    policy_t policy() const { return policy_; }
+    size_t switches() const { return switches_; }
+    size_t window_hits(policy_t p) const { return p == policy_t::lru ? lru_hits_ : lfu_hits_; }
+
+private:
+    struct Node_t {
+        Val_t val;
+        size_t freq;
+        size_t stamp;
+    };
+    struct Empty_t {};
+
+    size_t size_;
+    size_t sample_rate_;
+    size_t clock_ = 0;
+    std::unordered_map<Key_t, Node_t> hash_;
+    std::map<size_t, Key_t> by_recency_;
+    std::map<std::pair<size_t, size_t>, Key_t> by_freq_;
+
+    policy_t policy_ = policy_t::lru;
+    size_t switches_ = 0;
+    LRU_t<Key_t, Empty_t> shadow_lru_;
+    LFU_t<Key_t, Empty_t> shadow_lfu_;
+
+    // bit 0 - LRU shadow hit, bit 1 - LFU shadow hit
+    std::vector<unsigned char> window_;
+    size_t window_pos_ = 0;
+    size_t lru_hits_ = 0;
+    size_t lfu_hits_ = 0;
+
+    bool sampled(const Key_t &key) const {
+        if (sample_rate_ == 1)
+            return true;
+        // fibonacci hashing spreads consecutive keys over the sample buckets
+        size_t h = std::hash<Key_t>()(key) * static_cast<size_t>(0x9E3779B97F4A7C15ull);
+        return (h >> 16) % sample_rate_ == 0;
+    }
+
+    void train(const Key_t &key) {
+        auto empty = [](const Key_t &) { return Empty_t{}; };
+        unsigned char outcome = shadow_lru_.look_update(key, empty) | shadow_lfu_.look_update(key, empty) << 1;
+
+        unsigned char &old = window_[window_pos_];
+        lru_hits_ += (outcome & 1) - (old & 1);
+        lfu_hits_ += (outcome >> 1) - (old >> 1);
+        old = outcome;
+        window_pos_ = (window_pos_ + 1) % window_.size();
+
+        policy_t winner = policy_;
+        if (lru_hits_ > lfu_hits_)
+            winner = policy_t::lru;
+        else if (lfu_hits_ > lru_hits_)
+            winner = policy_t::lfu;
+        switches_ += winner != policy_;
+        policy_ = winner;
+    }
+
+    void touch(const Key_t &key, Node_t &node) {
+        by_recency_.erase(node.stamp);
+        by_freq_.erase(std::make_pair(node.freq, node.stamp));
+
+        node.freq++;
+        node.stamp = clock_++;
+        by_recency_[node.stamp] = key;
+        by_freq_[std::make_pair(node.freq, node.stamp)] = key;
+    }
+
+    void evict() {
+        if (hash_.empty())
+            return;
+        Key_t victim = policy_ == policy_t::lru ? by_recency_.begin()->second : by_freq_.begin()->second;
+        auto it = hash_.find(victim);
+        by_recency_.erase(it->second.stamp);
+        by_freq_.erase(std::make_pair(it->second.freq, it->second.stamp));
+        hash_.erase(it);
+    }
+};
+
+} // namespace caches
@@ -0,0 +1,155 @@
+#pragma once
+#include "cache.hpp"
+#include <cstdint>
+#include <functional>
+
+namespace caches {
+
+// Ring of 32-bit fingerprints of recently evicted keys. distance() tells how
+// many evictions ago the key left the cache, i.e. how many extra entries
+// would have kept it.
+class ghost_t {
+public:
+    static const size_t npos = std::numeric_limits<size_t>::max();
+
+    ghost_t(size_t capacity) : ring_(std::max<size_t>(capacity, 1)) {}
+
+    void push(uint32_t fp) {
+        size_t slot = seq_ % ring_.size();
+        if (seq_ >= ring_.size()) {
+            auto old = index_.find(ring_[slot]);
+            if (old != index_.end() && old->second == seq_ - ring_.size())
+                index_.erase(old);
+        }
+        ring_[slot] = fp;
+        index_[fp] = seq_++;
+    }
+
+    // forgets the fingerprint, a key can only be re-referenced once per eviction
+    size_t distance(uint32_t fp) {
+        auto it = index_.find(fp);
+        if (it == index_.end())
+            return npos;
+        size_t d = seq_ - 1 - it->second;
+        index_.erase(it);
+        return d;
+    }
+
+    size_t capacity() const { return ring_.size(); }
+
+private:
+    std::vector<uint32_t> ring_;
+    size_t seq_ = 0;
+    std::unordered_map<uint32_t, size_t> index_;
+};
+
+// Wraps a policy and estimates every `window` requests what resizing it would change:
+//  - gain(k): misses on keys that the ghost ring saw evicted less than k * step evictions
+//    ago, i.e. hits that k * step more entries would have added (k * step <= max_growth),
+//  - loss: hits on sampled keys that a shadow cache `step` entries smaller misses, scaled by the rate.
+// An entry is worth keeping if it brings at least `min_utility` hits per window: the
+// recommendation grows up to the farthest step whose own ghost hits pay off (this
+// jumps over LRU cliffs), or shrinks by one step if the last step doesn't pay off.
+// With auto_resize the capacity follows the recommendation.
+template <typename Key_t, typename Val_t, template <typename, typename> class Policy = LRU_t> class autotuned_t {
+public:
+    autotuned_t(size_t size, size_t step = 0, size_t window = 0, bool auto_resize = false, double min_utility = 0.1,
+                size_t sample_rate = 1, size_t max_growth = 0)
+        : cache_(size), step_(step ? step : std::max<size_t>(size / 8, 1)),
+          window_(window ? window : 16 * std::max<size_t>(size, 1)), auto_resize_(auto_resize),
+          min_utility_(min_utility), sample_rate_(std::max<size_t>(sample_rate, 1)),
+          ghost_(std::max(max_growth ? max_growth : size, step_)), shadow_(shadow_size(size)),
+          cur_gain_((ghost_.capacity() + step_ - 1) / step_, 0), gain_(cur_gain_), recommended_(size) {}
+
+    template <typename F> bool look_update(Key_t key, F slow_path) {
+        bool sampled = fingerprint(key) % sample_rate_ == 0;
+        bool shadow_hit = false;
+        if (sampled) {
+            auto empty = [](const Key_t &) { return Empty_t{}; };
+            shadow_hit = shadow_.look_update(key, empty);
+        }
+
+        bool hit = cache_.find(key) != nullptr;
+        if (hit) {
+            cur_loss_ += sampled && !shadow_hit;
+        } else {
+            size_t d = ghost_.distance(fingerprint(key));
+            if (d != ghost_t::npos)
+                cur_gain_[d / step_]++;
+            cache_.insert(key, slow_path(key), on_evict());
+        }
+
+        if (++requests_ % window_ == 0)
+            end_window();
+        return hit;
+    }
+
+    // extra hits per window from `extra` more entries and lost hits from `step` fewer, for the last window
+    size_t estimated_gain(size_t extra) const {
+        size_t gain = 0;
+        for (size_t k = 0; k < gain_.size() && k * step_ < extra; k++)
+            gain += gain_[k];
+        return gain;
+    }
+    size_t estimated_loss() const { return loss_ * sample_rate_; }
+    size_t recommended_capacity() const { return recommended_; }
+    size_t capacity() const { return cache_.capacity(); }
+
+private:
+    struct Empty_t {};
+
+    Policy<Key_t, Val_t> cache_;
+    size_t step_;
+    size_t window_;
+    bool auto_resize_;
+    double min_utility_;
+    size_t sample_rate_;
+
+    ghost_t ghost_;
+    Policy<Key_t, Empty_t> shadow_;
+
+    size_t requests_ = 0;
+    // ghost hits by eviction distance, bucket k covers [k * step, (k + 1) * step)
+    std::vector<size_t> cur_gain_;
+    std::vector<size_t> gain_;
+    size_t cur_loss_ = 0;
+    size_t loss_ = 0;
+    size_t recommended_;
+
+    static uint32_t fingerprint(const Key_t &key) {
+        uint64_t h = static_cast<uint64_t>(std::hash<Key_t>()(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<uint32_t>(h >> 32);
+    }
+
+    size_t shadow_size(size_t size) const {
+        return std::max<size_t>((size > step_ ? size - step_ : 1) / sample_rate_, 1);
+    }
+
+    struct on_evict_t {
+        ghost_t *ghost;
+        void operator()(const Key_t &key, Val_t &) const { ghost->push(fingerprint(key)); }
+    };
+    on_evict_t on_evict() { return on_evict_t{&ghost_}; }
+
+    void end_window() {
+        gain_.swap(cur_gain_);
+        std::fill(cur_gain_.begin(), cur_gain_.end(), 0);
+        loss_ = cur_loss_;
+        cur_loss_ = 0;
+
+        size_t size = cache_.capacity();
+        recommended_ = size;
+        for (size_t k = 0; k < gain_.size(); k++)
+            if (gain_[k] >= min_utility_ * step_)
+                recommended_ = size + (k + 1) * step_;
+        if (recommended_ == size && estimated_loss() < min_utility_ * step_ && size > step_)
+            recommended_ = size - step_;
+
+        if (auto_resize_ && recommended_ != size) {
+            cache_.resize(recommended_, on_evict());
+            shadow_.resize(shadow_size(recommended_), [](const Key_t &, Empty_t &) {});
+        }
+    }
+};
+
+} // namespace caches
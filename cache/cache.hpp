@@ -2,12 +2,16 @@
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <deque>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <limits>
 #include <list>
+#include <map>
 #include <set>
 #include <stack>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -15,76 +19,347 @@
 #define UNRECHEABLE() assert(!"This line should be unrecheable.");
 
 namespace caches {
+
+// low priority entries are admitted close to the eviction end of the cache
+enum class admission_t { normal, low };
+
 template <typename Key_t, typename Val_t> class LRU_t {
 public:
-    LRU_t(size_t size) : size_(size) {}
+    LRU_t(size_t size) : size_(size), old_begin_(cache_.end()) {}
+    LRU_t(const LRU_t &rhs) : size_(rhs.size_), old_begin_(cache_.end()) { copy_from(rhs); }
+    LRU_t &operator=(const LRU_t &rhs) {
+        if (this != &rhs) {
+            size_ = rhs.size_;
+            copy_from(rhs);
+        }
+        return *this;
+    }
+    LRU_t(LRU_t &&rhs) : size_(rhs.size_), old_begin_(cache_.end()) { move_from(rhs); }
+    LRU_t &operator=(LRU_t &&rhs) {
+        if (this != &rhs) {
+            size_ = rhs.size_;
+            move_from(rhs);
+        }
+        return *this;
+    }
 
     template <typename F> bool look_update(Key_t key, F slow_path) {
-        auto hit = hash_.find(key);
+        if (find(key))
+            return true;
+        insert(key, std::move(slow_path(key)));
+        return false;
+    }
 
-        if (hit == hash_.end()) {
-            if (full()) {
-                hash_.erase(cache_.back());
-                cache_.pop_back();
-            }
-            cache_.push_front(std::move(slow_path(key)));
-            hash_[key] = cache_.begin();
-            return false;
-        }
+    Val_t *find(const Key_t &key) {
+        auto hit = hash_.find(key);
+        if (hit == hash_.end())
+            return nullptr;
 
         auto eltit = hit->second;
+        if (eltit->old) {
+            if (eltit == old_begin_)
+                old_begin_ = std::next(eltit);
+            eltit->old = false;
+            young_++;
+        }
         if (eltit != cache_.begin())
             cache_.splice(cache_.begin(), cache_, eltit, std::next(eltit));
+        balance();
+        return &eltit->val;
+    }
+
+    const Val_t *peek(const Key_t &key) const {
+        auto hit = hash_.find(key);
+        return hit == hash_.end() ? nullptr : &hit->second->val;
+    }
+
+    bool contains(const Key_t &key) const { return hash_.count(key); }
+
+    // on_evict(key, val) is called for the victim right before it leaves the cache.
+    // Low priority entries start at the head of the old part of the list instead
+    // of its front, so an unused one is evicted before anything recently touched
+    // but after regular entries that have gone stale.
+    template <typename E>
+    void insert(Key_t key, Val_t val, E on_evict, admission_t admission = admission_t::normal) {
+        auto hit = hash_.find(key);
+        if (hit != hash_.end()) {
+            hit->second->val = std::move(val);
+            if (admission == admission_t::normal)
+                find(key);
+            return;
+        }
+
+        if (full() && !cache_.empty())
+            evict(std::prev(cache_.end()), on_evict);
+        if (admission == admission_t::low) {
+            old_begin_ = cache_.insert(old_begin_, Node_t{key, std::move(val), true});
+            hash_[key] = old_begin_;
+            return;
+        }
+        cache_.push_front(Node_t{key, std::move(val), false});
+        hash_[key] = cache_.begin();
+        young_++;
+        balance();
+    }
+
+    void insert(Key_t key, Val_t val) {
+        insert(key, std::move(val), [](const Key_t &, Val_t &) {});
+    }
+
+    bool erase(const Key_t &key, Val_t *out = nullptr) {
+        auto hit = hash_.find(key);
+        if (hit == hash_.end())
+            return false;
+
+        if (out)
+            *out = std::move(hit->second->val);
+        unlink(hit->second);
+        cache_.erase(hit->second);
+        hash_.erase(hit);
         return true;
     }
 
+    template <typename E> void resize(size_t size, E on_evict) {
+        size_ = size;
+        while (cache_.size() > size_)
+            evict(std::prev(cache_.end()), on_evict);
+        balance();
+    }
+
+    size_t size() const { return cache_.size(); }
+    size_t capacity() const { return size_; }
+
 private:
+    struct Node_t {
+        Key_t key;
+        Val_t val;
+        bool old;
+    };
     size_t size_;
-    using ListIt_t = typename std::list<Val_t>::iterator;
-    std::list<Val_t> cache_;
+    using ListIt_t = typename std::list<Node_t>::iterator;
+    std::list<Node_t> cache_;
     std::unordered_map<Key_t, ListIt_t> hash_;
+    // the young head of the list holds a quarter of the capacity, the rest is
+    // old; old_begin_ is the first old entry, end() when there is none
+    ListIt_t old_begin_;
+    size_t young_ = 0;
+
+    bool full() { return cache_.size() >= size_; }
+
+    // regular entries are pushed past the split once the young part is over its share
+    void balance() {
+        const size_t young_max = std::max<size_t>(size_ / 4, 1);
+        while (young_ > young_max) {
+            old_begin_ = std::prev(old_begin_);
+            old_begin_->old = true;
+            young_--;
+        }
+    }
 
-    bool full() { return cache_.size() == size_; }
+    void unlink(ListIt_t victim) {
+        if (victim == old_begin_)
+            old_begin_ = std::next(victim);
+        if (!victim->old)
+            young_--;
+    }
+
+    template <typename E> void evict(ListIt_t victim, E &on_evict) {
+        unlink(victim);
+        hash_.erase(victim->key);
+        on_evict(victim->key, victim->val);
+        cache_.erase(victim);
+    }
+
+    // list iterators can't be copied from another list, so the index is rebuilt
+    void copy_from(const LRU_t &rhs) {
+        cache_ = rhs.cache_;
+        hash_.clear();
+        old_begin_ = cache_.end();
+        young_ = rhs.young_;
+        for (auto it = cache_.begin(); it != cache_.end(); it++) {
+            hash_[it->key] = it;
+            if (it->old && old_begin_ == cache_.end())
+                old_begin_ = it;
+        }
+    }
+
+    // nodes keep their addresses, only the end() sentinel has to be translated
+    void move_from(LRU_t &rhs) {
+        bool no_old = rhs.old_begin_ == rhs.cache_.end();
+        cache_ = std::move(rhs.cache_);
+        hash_ = std::move(rhs.hash_);
+        old_begin_ = no_old ? cache_.end() : rhs.old_begin_;
+        young_ = rhs.young_;
+        rhs.cache_.clear();
+        rhs.hash_.clear();
+        rhs.old_begin_ = rhs.cache_.end();
+        rhs.young_ = 0;
+    }
 };
 
+// With aging_period = K every K lookups all frequencies are halved, so keys
+// that were hot before a workload shift don't pin the cache forever. Only
+// find() advances the clock, so a lookup followed by an insert of the missed
+// key is one access. Aging is O(size) and K is raised to the size if it is
+// smaller, which keeps it amortized O(1).
 template <typename Key_t, typename Val_t> class LFU_t {
 public:
-    LFU_t(size_t size) : size_(size), min_freq_(1), n_elemets_(0) {}
+    LFU_t(size_t size, size_t aging_period = 0)
+        : size_(size), min_freq_(1), n_elemets_(0),
+          aging_period_(aging_period ? std::max(aging_period, size) : 0) {}
 
     template <typename F> bool look_update(Key_t key, F slow_path) {
-        if (hash_map_.find(key) != hash_map_.end()) {
-            auto it = hash_map_[key];
-            auto freq = it->freq++;
-
-            freq_map_[freq + 1].push_front(std::move(*it));
-            freq_map_[freq].erase(it);
-            if (freq_map_[freq].empty()) {
-                freq_map_.erase(freq);
-                min_freq_ += freq == min_freq_;
-            }
+        if (find(key))
+            return true;
+        admit(key, std::move(slow_path(key)), [](const Key_t &, Val_t &) {}, admission_t::normal);
+        return false;
+    }
 
-            hash_map_[key] = freq_map_[freq + 1].begin();
+    Val_t *find(const Key_t &key) {
+        tick();
+        auto hit = hash_map_.find(key);
+        if (hit == hash_map_.end())
+            return nullptr;
+
+        hit->second = touch(hit->second);
+        return &hit->second->val;
+    }
 
+    const Val_t *peek(const Key_t &key) const {
+        auto hit = hash_map_.find(key);
+        return hit == hash_map_.end() ? nullptr : &hit->second->val;
+    }
+
+    bool contains(const Key_t &key) const { return hash_map_.count(key); }
+
+    // on_evict(key, val) is called for the victim right before it leaves the cache
+    template <typename E>
+    void insert(Key_t key, Val_t val, E on_evict, admission_t admission = admission_t::normal) {
+        admit(key, std::move(val), on_evict, admission);
+    }
+
+    void insert(Key_t key, Val_t val) {
+        insert(key, std::move(val), [](const Key_t &, Val_t &) {});
+    }
+
+    // moves the entry into the bucket of the given frequency (at least 1)
+    bool set_freq(const Key_t &key, size_t freq) {
+        auto hit = hash_map_.find(key);
+        if (hit == hash_map_.end())
+            return false;
+
+        freq = std::max<size_t>(freq, 1);
+        auto it = hit->second;
+        auto old = it->freq;
+        if (old == freq)
             return true;
+
+        it->freq = freq;
+        auto &bucket = freq_map_[freq];
+        bucket.splice(bucket.begin(), freq_map_[old], it);
+        if (freq_map_[old].empty()) {
+            freq_map_.erase(old);
+            if (old == min_freq_ && freq > old)
+                update_min_freq();
+        }
+        min_freq_ = std::min(min_freq_, freq);
+        return true;
+    }
+
+    // halves every frequency in O(size), buckets that collapse into one keep the
+    // entries of the higher frequency closer to the head: 2t + 1 goes in front of
+    // 2t, and 3, 2, 1 are merged last in this order
+    void age() {
+        std::unordered_map<size_t, List_t> aged;
+        auto move = [&](size_t f, List_t &src) {
+            auto target = std::max<size_t>(f / 2, 1);
+            for (auto &node : src)
+                node.freq = target;
+            auto &dst = aged[target];
+            dst.splice(f % 2 && f > 1 && target > 1 ? dst.begin() : dst.end(), src);
+        };
+        for (auto &f : freq_map_)
+            if (f.first > 3)
+                move(f.first, f.second);
+        for (size_t f : {3, 2, 1}) {
+            auto it = freq_map_.find(f);
+            if (it != freq_map_.end())
+                move(f, it->second);
         }
+        freq_map_.swap(aged);
+        update_min_freq();
+    }
 
-        if (n_elemets_ >= size_) {
-            auto key = freq_map_[min_freq_].back().key;
-            hash_map_.erase(key);
-            freq_map_[min_freq_].pop_back();
-            if (freq_map_[min_freq_].empty())
-                freq_map_.erase(min_freq_);
-            n_elemets_--;
+private:
+    template <typename E> void admit(Key_t key, Val_t val, E on_evict, admission_t admission) {
+        auto hit = hash_map_.find(key);
+        if (hit != hash_map_.end()) {
+            hit->second->val = std::move(val);
+            if (admission == admission_t::normal)
+                hit->second = touch(hit->second);
+            return;
         }
 
+        if (n_elemets_ >= size_)
+            evict(on_evict);
+
         n_elemets_++;
         min_freq_ = 1;
-        freq_map_[min_freq_].push_front(std::move(Node_t{key, std::move(slow_path(key)), min_freq_}));
-        hash_map_[key] = freq_map_[min_freq_].begin();
+        auto &bucket = freq_map_[min_freq_];
+        if (admission == admission_t::low) {
+            bucket.push_back(Node_t{key, std::move(val), min_freq_});
+            hash_map_[key] = std::prev(bucket.end());
+            return;
+        }
+        bucket.push_front(std::move(Node_t{key, std::move(val), min_freq_}));
+        hash_map_[key] = bucket.begin();
+    }
 
-        return false;
+    template <typename E> void evict(E &on_evict) {
+        auto &victim = freq_map_[min_freq_].back();
+        hash_map_.erase(victim.key);
+        on_evict(victim.key, victim.val);
+        freq_map_[min_freq_].pop_back();
+        if (freq_map_[min_freq_].empty())
+            freq_map_.erase(min_freq_);
+        n_elemets_--;
+    }
+
+public:
+    template <typename E> void resize(size_t size, E on_evict) {
+        size_ = size;
+        if (aging_period_)
+            aging_period_ = std::max(aging_period_, size_);
+        while (n_elemets_ > size_) {
+            evict(on_evict);
+            if (!freq_map_.count(min_freq_))
+                update_min_freq();
+        }
+    }
+
+    bool erase(const Key_t &key, Val_t *out = nullptr) {
+        auto hit = hash_map_.find(key);
+        if (hit == hash_map_.end())
+            return false;
+
+        auto it = hit->second;
+        auto freq = it->freq;
+        if (out)
+            *out = std::move(it->val);
+        hash_map_.erase(hit);
+        freq_map_[freq].erase(it);
+        n_elemets_--;
+        if (freq_map_[freq].empty()) {
+            freq_map_.erase(freq);
+            if (freq == min_freq_)
+                update_min_freq();
+        }
+        return true;
     }
 
+    size_t size() const { return n_elemets_; }
+    size_t capacity() const { return size_; }
+
     void dump() const {
         for (auto &f : freq_map_) {
             std::cout << f.first << "\n";
@@ -103,28 +378,148 @@ private:
     size_t size_;
     size_t min_freq_;
     size_t n_elemets_;
+    size_t aging_period_;
+    size_t ops_ = 0;
 
     using List_t = typename std::list<Node_t>;
     using ListIt_t = typename std::list<Node_t>::iterator;
     std::unordered_map<Key_t, ListIt_t> hash_map_;
     std::unordered_map<size_t, List_t> freq_map_;
+
+    ListIt_t touch(ListIt_t it) {
+        auto freq = it->freq++;
+
+        freq_map_[freq + 1].push_front(std::move(*it));
+        freq_map_[freq].erase(it);
+        if (freq_map_[freq].empty()) {
+            freq_map_.erase(freq);
+            min_freq_ += freq == min_freq_;
+        }
+
+        return freq_map_[freq + 1].begin();
+    }
+
+    void tick() {
+        if (aging_period_ && ++ops_ >= aging_period_) {
+            ops_ = 0;
+            age();
+        }
+    }
+
+    // O(number of distinct frequencies), only needed after an arbitrary erase or aging
+    void update_min_freq() {
+        min_freq_ = 1;
+        if (freq_map_.empty())
+            return;
+        min_freq_ = freq_map_.begin()->first;
+        for (const auto &f : freq_map_)
+            min_freq_ = std::min(min_freq_, f.first);
+    }
 };
 
-template <typename Key_t, typename Val_t> class perfect_t {
+// Windowed LFU: frequency of a key is the number of its requests among the
+// last `window` requests, so the ranking follows the current hot set.
+template <typename Key_t, typename Val_t> class WLFU_t {
 public:
-    perfect_t(size_t size, std::vector<Key_t> &req) : size_(size), current_request_index(0) {
-        hits_history_.resize(req.size());
-        req_extend_.resize(req.size());
+    WLFU_t(size_t size, size_t window) : lfu_(size), window_size_(std::max<size_t>(window, 1)) {}
+
+    template <typename F> bool look_update(Key_t key, F slow_path) {
+        window_.push_back(key);
+        counts_[key]++;
+        if (window_.size() > window_size_) {
+            auto old = window_.front();
+            window_.pop_front();
+            auto it = counts_.find(old);
+            if (--it->second == 0)
+                counts_.erase(it);
+            else
+                lfu_.set_freq(old, it->second);
+        }
 
-        // save key & it's index in sequence
-        for (size_t i = 0; i < req.size(); i++)
-            req_extend_[i] = triple{req[i], i, std::numeric_limits<size_t>::max()};
+        bool hit = lfu_.look_update(key, slow_path);
+        lfu_.set_freq(key, counts_[key]);
+        return hit;
+    }
+
+    const LFU_t<Key_t, Val_t> &cache() const { return lfu_; }
+
+private:
+    LFU_t<Key_t, Val_t> lfu_;
+    size_t window_size_;
+    std::deque<Key_t> window_;
+    std::unordered_map<Key_t, size_t> counts_;
+};
 
-        misses_amount();
+#ifdef DONT_CACHE_SINGLES_PAGES
+const bool skip_singles_default = true;
+#else
+const bool skip_singles_default = false;
+#endif
+
+namespace detail {
+const size_t never = std::numeric_limits<size_t>::max();
+
+// next[i] - index of the next request of the same key, `never` if there is none.
+// Integer keys are LSD radix sorted together with their indices (the sort is
+// stable, so equal keys stay in request order), other keys use a hash table.
+template <typename Key_t>
+void next_use(const std::vector<Key_t> &req, std::vector<size_t> &next, std::true_type /* integral */) {
+    using U = typename std::make_unsigned<Key_t>::type;
+    const U sign = std::is_signed<Key_t>::value ? U(U(1) << (8 * sizeof(U) - 1)) : U(0);
+    const size_t N = req.size();
+
+    std::vector<std::pair<U, size_t>> cur(N), tmp(N);
+    for (size_t i = 0; i < N; i++)
+        cur[i] = std::make_pair(static_cast<U>(req[i]) ^ sign, i);
+
+    for (size_t shift = 0; shift < 8 * sizeof(U); shift += 8) {
+        size_t count[257] = {};
+        for (const auto &it : cur)
+            count[((it.first >> shift) & 0xFF) + 1]++;
+        // all keys share this byte, the pass wouldn't change the order
+        if (std::find(count + 1, count + 257, N) != count + 257)
+            continue;
+        for (size_t d = 0; d < 256; d++)
+            count[d + 1] += count[d];
+        for (const auto &it : cur)
+            tmp[count[(it.first >> shift) & 0xFF]++] = it;
+        cur.swap(tmp);
+    }
+
+    next.assign(N, never);
+    for (size_t i = 0; i + 1 < N; i++)
+        if (cur[i].first == cur[i + 1].first)
+            next[cur[i].second] = cur[i + 1].second;
+}
+
+template <typename Key_t>
+void next_use(const std::vector<Key_t> &req, std::vector<size_t> &next, std::false_type /* integral */) {
+    std::unordered_map<Key_t, size_t> last_seen;
+    next.assign(req.size(), never);
+    for (size_t i = req.size(); i-- > 0;) {
+        auto it = last_seen.find(req[i]);
+        if (it != last_seen.end()) {
+            next[i] = it->second;
+            it->second = i;
+        } else {
+            last_seen.emplace(req[i], i);
+        }
+    }
+}
+} // namespace detail
+
+// Belady's algorithm: on a miss the cached key with the farthest next use is evicted.
+// With skip_singles a key that is never requested again isn't cached at all.
+template <typename Key_t, typename Val_t> class perfect_t {
+public:
+    perfect_t(size_t size, const std::vector<Key_t> &req, bool skip_singles = skip_singles_default)
+        : size_(size), current_request_index(0), skip_singles_(skip_singles) {
+        detail::next_use(req, next_, std::is_integral<Key_t>());
+        total_misses_ = simulate(req);
     }
 
     template <typename F> bool look_update(Key_t key, F slow_path) {
-        if (current_request_index >= req_extend_.size()) {
+        if (current_request_index >= hits_history_.size()) {
             UNRECHEABLE();
             return false;
         }
@@ -132,74 +527,55 @@ public:
         return hits_history_[current_request_index++];
     }
 
-    size_t misses_amount() {
-        // sorting by key value
-        std::sort(req_extend_.begin(), req_extend_.end(), [](const triple &lhs, const triple &rhs) {
-            bool is_same_key = lhs.key == rhs.key;
-            return is_same_key ? lhs.idx < rhs.idx : lhs.key < rhs.key;
-        });
+    // optimal decision for every request of the sequence: 1 - hit, 0 - miss
+    const std::vector<bool> &hits_history() const { return hits_history_; }
 
-        for (size_t i = 0; i + 1 < req_extend_.size(); i++) {
-            if (req_extend_[i].key == req_extend_[i + 1].key) {
-                req_extend_[i].next = req_extend_[i + 1].idx;
-            }
-        }
+    size_t misses_amount() const { return total_misses_; }
 
-        // sorting by idx
-        std::sort(req_extend_.begin(), req_extend_.end(),
-                  [](const triple &lhs, const triple &rhs) { return lhs.idx < rhs.idx; });
+private:
+    size_t size_;
+    std::vector<bool> hits_history_;
+    size_t current_request_index;
+    bool skip_singles_;
+    size_t total_misses_;
+    std::vector<size_t> next_;
+
+    size_t simulate(const std::vector<Key_t> &req) {
+        // cached keys ordered by their next use, the last one is the victim
+        using Order_t = std::multimap<size_t, Key_t>;
+        Order_t order;
+        std::unordered_map<Key_t, typename Order_t::iterator> cache_table;
 
-        Cache_table_t cache_table;
-        size_t N_iterations = req_extend_.size();
+        size_t N_iterations = req.size();
         size_t total_misses = 0;
+        hits_history_.assign(N_iterations, false);
 
         for (size_t i = 0; i < N_iterations; i++) {
-            int cur_key = req_extend_[i].key;
+            const Key_t &cur_key = req[i];
 
-            if (cache_table.count(cur_key) == 1) {
-                cache_table[cur_key] = req_extend_[i].next;
+            auto hit = cache_table.find(cur_key);
+            if (hit != cache_table.end()) {
+                order.erase(hit->second);
+                hit->second = order.emplace(next_[i], cur_key);
                 hits_history_[i] = 1;
                 continue;
             }
 
             total_misses++;
-            hits_history_[i] = 0;
-
-#ifdef DONT_CACHE_SINGLES_PAGES
-            if (req_extend_[i].next == std::numeric_limits<size_t>::max())
+            if (skip_singles_ && next_[i] == detail::never)
                 continue;
-#endif
 
-            auto remove_key = cur_key;
-            size_t dist = 0;
-            for (const auto &p : cache_table) {
-                if (p.second > dist) {
-                    dist = p.second;
-                    remove_key = p.first;
-                }
+            if (size_ == cache_table.size()) {
+                auto victim = std::prev(order.end());
+                cache_table.erase(victim->second);
+                order.erase(victim);
             }
-
-            if (size_ == cache_table.size())
-                cache_table.erase(remove_key);
-
-            cache_table[cur_key] = req_extend_[i].next;
+            if (size_)
+                cache_table[cur_key] = order.emplace(next_[i], cur_key);
         }
 
         return total_misses;
     }
-
-private:
-    size_t size_;
-    std::vector<bool> hits_history_;
-    size_t current_request_index;
-    using Cache_table_t = std::unordered_map<int, size_t>;
-
-    struct triple {
-        int key;
-        size_t idx;
-        size_t next;
-    };
-    std::vector<triple> req_extend_;
 };
 
 } // namespace caches
@@ -0,0 +1,142 @@
+#pragma once
+#include "cache.hpp"
+#include <functional>
+#include <iterator>
+
+namespace caches {
+
+// Hawkeye-like reuse predictor: a table of 3-bit saturating counters indexed by
+// a hash of the key. Belady's decisions are reconstructed online the way OPTgen
+// does it: for the last `window` requests we keep how many lines the optimal
+// cache would hold at each moment. When a key comes back, its previous use is
+// an OPT hit if the cache wasn't full anywhere in between; the reuse then trains
+// the key towards cache-friendly, otherwise towards cache-averse. Only requests
+// that already arrived are read, reuses longer than the window teach nothing.
+template <typename Key_t> class belady_predictor_t {
+public:
+    belady_predictor_t(size_t cache_size, size_t window = 0, size_t table_bits = 11)
+        : cache_size_(cache_size), occupancy_(window ? window : 8 * std::max<size_t>(cache_size, 1)),
+          counters_(size_t(1) << table_bits, threshold_ - 1) {}
+
+    // learns from a request that has just arrived
+    void access(const Key_t &key) {
+        const size_t window = occupancy_.size();
+        occupancy_[time_ % window] = 0;
+
+        auto last = last_use_.find(key);
+        if (last != last_use_.end() && time_ - last->second < window) {
+            bool opt_hit = true;
+            for (size_t t = last->second; t < time_ && opt_hit; t++)
+                opt_hit = occupancy_[t % window] < cache_size_;
+            if (opt_hit)
+                for (size_t t = last->second; t < time_; t++)
+                    occupancy_[t % window]++;
+            update(key, opt_hit);
+        }
+        last_use_[key] = time_++;
+
+        // forget keys whose last use left the window, this keeps the map O(window)
+        if (last_use_.size() > 2 * window)
+            for (auto it = last_use_.begin(); it != last_use_.end();)
+                it = time_ - it->second >= window ? last_use_.erase(it) : std::next(it);
+    }
+
+    // replays a recorded trace, e.g. a warm-up prefix, before the cache goes online
+    void train(const std::vector<Key_t> &req) {
+        for (const auto &key : req)
+            access(key);
+    }
+
+    void update(const Key_t &key, bool friendly) {
+        auto &cnt = counters_[index(key)];
+        if (friendly && cnt < max_counter_)
+            cnt++;
+        if (!friendly && cnt > 0)
+            cnt--;
+    }
+
+    bool is_friendly(const Key_t &key) const { return counters_[index(key)] >= threshold_; }
+
+private:
+    enum : unsigned char { max_counter_ = 7, threshold_ = 4 };
+    size_t cache_size_;
+    size_t time_ = 0;
+    std::vector<size_t> occupancy_;
+    std::unordered_map<Key_t, size_t> last_use_;
+    std::vector<unsigned char> counters_;
+
+    size_t index(const Key_t &key) const {
+        size_t h = std::hash<Key_t>()(key) * static_cast<size_t>(0x9E3779B97F4A7C15ull);
+        return (h >> 16) & (counters_.size() - 1);
+    }
+};
+
+// Keeps cache-averse lines in a separate LRU list that is always drained first.
+// Every request also trains the predictor. Evicting a line predicted as friendly
+// means the predictor was wrong, so the key is detrained the same way Hawkeye does it.
+template <typename Key_t, typename Val_t> class hawkeye_t {
+public:
+    hawkeye_t(size_t size) : hawkeye_t(size, belady_predictor_t<Key_t>(size)) {}
+    hawkeye_t(size_t size, const belady_predictor_t<Key_t> &predictor) : size_(size), predictor_(predictor) {}
+
+    template <typename F> bool look_update(Key_t key, F slow_path) {
+        predictor_.access(key);
+        auto hit = hash_.find(key);
+        if (hit != hash_.end()) {
+            auto &list = predictor_.is_friendly(key) ? friendly_ : averse_;
+            place(hit->second, list);
+            return true;
+        }
+
+        if (hash_.size() >= size_)
+            evict();
+
+        auto &list = predictor_.is_friendly(key) ? friendly_ : averse_;
+        list.push_front(Node_t{key, std::move(slow_path(key))});
+        hash_[key] = Pos_t{&list, list.begin()};
+        return false;
+    }
+
+    size_t averse_evictions() const { return averse_evictions_; }
+    size_t friendly_evictions() const { return friendly_evictions_; }
+
+private:
+    struct Node_t {
+        Key_t key;
+        Val_t val;
+    };
+    using List_t = std::list<Node_t>;
+    struct Pos_t {
+        List_t *list;
+        typename List_t::iterator it;
+    };
+
+    size_t size_;
+    belady_predictor_t<Key_t> predictor_;
+    List_t friendly_;
+    List_t averse_;
+    std::unordered_map<Key_t, Pos_t> hash_;
+    size_t averse_evictions_ = 0;
+    size_t friendly_evictions_ = 0;
+
+    void place(Pos_t &pos, List_t &list) {
+        list.splice(list.begin(), *pos.list, pos.it);
+        pos.list = &list;
+    }
+
+    void evict() {
+        List_t *victim_list = &averse_;
+        if (averse_.empty()) {
+            victim_list = &friendly_;
+            friendly_evictions_++;
+            predictor_.update(friendly_.back().key, false);
+        } else {
+            averse_evictions_++;
+        }
+
+        hash_.erase(victim_list->back().key);
+        victim_list->pop_back();
+    }
+};
+
+} // namespace caches
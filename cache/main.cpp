@@ -1,4 +1,16 @@
 #include "cache.hpp"
+#include "tiered.hpp"
+#include "adaptive.hpp"
+#include "learned.hpp"
+#include "stream_perfect.hpp"
+#include "prefetch.hpp"
+#include "write_back.hpp"
+#include "autotune.hpp"
+#include "slab.hpp"
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
 #include <iomanip>
 #include <iostream>
 
@@ -28,12 +40,17 @@ template <typename K, typename V> struct Make_cache<caches::LFU_t<K, V>> {
     static caches::LFU_t<K, V> get(Test_t &t) { return caches::LFU_t<K, V>(t.N); }
 };
 
-template <typename Cache_t, size_t N_tests> void test_cache(Test_t *tests, const char *title_msg) {
+template <typename K, typename V> struct Make_cache<caches::LRU_t<K, V>> {
+    static caches::LRU_t<K, V> get(Test_t &t) { return caches::LRU_t<K, V>(t.N); }
+};
+
+template <typename Cache_t, size_t N_tests, typename M>
+void test_cache(Test_t *tests, const char *title_msg, M make_cache) {
     std::cout << title_msg << std::endl;
     auto slow_path = [](int key) -> int { return key; };
 
     for (size_t i = 0; i < N_tests; i++) {
-        Cache_t cache = Make_cache<Cache_t>::get(tests[i]);
+        Cache_t cache = make_cache(tests[i]);
         size_t answ = 0;
         for (const auto &it : tests[i].req) {
             bool hit = cache.look_update(it, slow_path);
@@ -54,6 +71,10 @@ template <typename Cache_t, size_t N_tests> void test_cache(Test_t *tests, const
     }
 }
 
+template <typename Cache_t, size_t N_tests> void test_cache(Test_t *tests, const char *title_msg) {
+    test_cache<Cache_t, N_tests>(tests, title_msg, Make_cache<Cache_t>::get);
+}
+
 void test_caches() {
     Test_t tests_perfect[] = {
         {1, {1, 1}, 1},
@@ -71,6 +92,34 @@ void test_caches() {
     test_cache<caches::perfect_t<int, int>, sizeof(tests_perfect) / sizeof(Test_t)>(tests_perfect,
                                                                                     "Perfect cache testing");
 
+    // keys differ only in the upper 32 bits
+    const uint64_t high = uint64_t(1) << 32;
+    std::vector<uint64_t> wide_req = {1, 1 + high, 1, 1 + high, 2 + high, 2, 2 + high, 1};
+    caches::perfect_t<uint64_t, int> wide_cache(1, wide_req, false);
+    caches::perfect_t<std::string, int> string_cache(1, {"1", "4294967297", "1", "4294967297", "4294967298", "2",
+                                                         "4294967298", "1"},
+                                                     false);
+    std::cout << "Perfect cache with 64-bit keys testing" << std::endl;
+    print_test_title(1, 2, wide_cache.misses_amount() == 8);
+    print_test_title(2, 2, string_cache.misses_amount() == wide_cache.misses_amount());
+
+    std::cout << "Streaming perfect cache testing" << std::endl;
+    const size_t N_perfect = sizeof(tests_perfect) / sizeof(Test_t);
+    for (size_t i = 0; i < N_perfect; i++) {
+        std::stringstream trace;
+        for (const auto &it : tests_perfect[i].req)
+            trace << it << " ";
+        // lookahead over the whole sequence has to match the offline algorithm
+        caches::stream_perfect_t<int> cache(tests_perfect[i].N, tests_perfect[i].req.size());
+        size_t answ = cache.misses_amount(trace, tests_perfect[i].req.size());
+        print_test_title(i + 1, N_perfect, answ == tests_perfect[i].answ);
+        if (answ != tests_perfect[i].answ) {
+            std::cout << "Misses got      = " << answ << std::endl
+                      << "Misses expected = " << tests_perfect[i].answ << std::endl;
+            break;
+        }
+    }
+
     Test_t tests_LFU[] = {{1, {1, 1}, 1},
                           {1, {1, 2}, 2},
                           {2, {1, 1}, 1},
@@ -82,6 +131,219 @@ void test_caches() {
                           {4, {1, 2, 1, 3, 2, 4, 5}, 5},
                           {3, {7, 0, 1, 2, 0, 3, 0, 4, 2, 3, 0, 3, 2, 1, 2}, 9}};
     test_cache<caches::LFU_t<int, int>, sizeof(tests_LFU) / sizeof(Test_t)>(tests_LFU, "LFU cache testing");
+
+    // old hot keys 1 and 2 have to be forgotten to let 3 and 4 share the cache, after that nothing misses
+    Test_t tests_aging[] = {{2, {1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 3, 4, 3, 4, 3, 4, 3, 4, 3, 4, 3, 4}, 9},
+                            {2, {1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 3, 4, 3, 4, 3, 4, 3, 4, 3, 4, 3, 4, 3, 4, 3, 4}, 9},
+                            {3, {1, 2, 3, 4, 3, 3, 3, 5, 5, 5, 5, 1}, 6}};
+    test_cache<caches::LFU_t<int, int>, sizeof(tests_aging) / sizeof(Test_t)>(
+        tests_aging, "LFU with aging testing", [](Test_t &t) { return caches::LFU_t<int, int>(t.N, 4); });
+
+    Test_t tests_WLFU[] = {{2, {1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 3, 4, 3, 4, 3, 4, 3, 4, 3, 4, 3, 4}, 6},
+                           {3, {1, 2, 3, 4, 3, 3, 3, 5, 5, 5, 5, 1}, 6}};
+    test_cache<caches::WLFU_t<int, int>, sizeof(tests_WLFU) / sizeof(Test_t)>(
+        tests_WLFU, "Windowed LFU testing", [](Test_t &t) { return caches::WLFU_t<int, int>(t.N, 4); });
+
+    Test_t tests_LRU[] = {{1, {1, 1}, 1},
+                          {1, {1, 2, 1}, 3},
+                          {2, {1, 2, 1, 3, 2}, 4},
+                          {2, {1, 2, 1, 3, 1, 2}, 4},
+                          {3, {1, 2, 3, 4, 1, 2, 5, 1, 2, 3, 4, 5}, 10}};
+    test_cache<caches::LRU_t<int, int>, sizeof(tests_LRU) / sizeof(Test_t)>(tests_LRU, "LRU cache testing");
+
+    // hot keys among one-shot scans favour LFU, a new working set afterwards favours LRU
+    Test_t tests_adaptive[] = {
+        {3, {1, 1, 1, 2, 2, 2, 3, 4, 1, 5, 6, 2, 7, 8, 1, 9, 10, 2, 11, 12, 1, 13, 14, 2}, 17},
+        {2, {1, 1, 1, 1, 1, 2, 3, 2, 3, 2, 3, 2, 3, 2, 3, 2, 3, 2, 3, 2, 3}, 3},
+        {3, {1,  1,  1,  2,  2,  2,  3,  4,  1,  5,  6,  2,  7,  8,  1,  9,  10, 2,  11,
+             12, 1,  13, 14, 2,  20, 21, 20, 21, 20, 21, 20, 21, 20, 21, 20, 21, 20, 21},
+         19},
+    };
+    test_cache<caches::adaptive_t<int, int>, sizeof(tests_adaptive) / sizeof(Test_t)>(
+        tests_adaptive, "Adaptive cache testing", [](Test_t &t) { return caches::adaptive_t<int, int>(t.N, 4); });
+
+    // the predictor learns online, it only sees the requests replayed so far
+    Test_t tests_hawkeye[] = {
+        {4, {1, 2, 3, 4, 5, 1, 2, 3, 4, 6, 1, 2, 3, 4, 7, 1, 2, 3, 4, 8, 1, 2, 3, 4}, 15},
+        {4, {1, 2, 3, 4, 5, 1, 2, 3, 4, 5, 1, 2, 3, 4, 5, 1, 2, 3, 4, 5, 1, 2, 3, 4, 5, 5}, 16},
+    };
+    test_cache<caches::hawkeye_t<int, int>, sizeof(tests_hawkeye) / sizeof(Test_t)>(
+        tests_hawkeye, "Hawkeye cache testing", [](Test_t &t) { return caches::hawkeye_t<int, int>(t.N); });
+
+    // warmed up on a different trace with the same hot keys and other one-shot keys
+    std::vector<int> warm_up;
+    for (int i = 0; i < 10; i++) {
+        warm_up.insert(warm_up.end(), {1, 2, 3, 4});
+        warm_up.push_back(100 + i);
+    }
+    Test_t tests_hawkeye_warm[] = {
+        {4, {1, 2, 3, 4, 200, 1, 2, 3, 4, 201, 1, 2, 3, 4, 202, 1, 2, 3, 4, 203, 1, 2, 3, 4, 204}, 13},
+    };
+    test_cache<caches::hawkeye_t<int, int>, sizeof(tests_hawkeye_warm) / sizeof(Test_t)>(
+        tests_hawkeye_warm, "Warmed up Hawkeye cache testing", [&warm_up](Test_t &t) {
+            caches::belady_predictor_t<int> predictor(t.N);
+            predictor.train(warm_up);
+            return caches::hawkeye_t<int, int>(t.N, predictor);
+        });
+
+    using Prefetcher_t = caches::prefetcher_t<int, int>;
+    Test_t tests_prefetch[] = {
+        {4, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12}, 3},
+        {4, {10, 20, 30, 40, 50, 60, 70, 80}, 3},
+        {4, {9, 8, 7, 6, 5, 4, 3, 2, 1}, 3},
+        {4, {1, 2, 3, 4, 100, 200, 300, 400, 7, 8}, 8},
+        {2, {1, 5, 2, 9, 3, 4, 11}, 7},
+    };
+    test_cache<Prefetcher_t, sizeof(tests_prefetch) / sizeof(Test_t)>(
+        tests_prefetch, "Prefetcher testing", [](Test_t &t) { return Prefetcher_t(t.N); });
+
+    // both tiers have t.N entries
+    using Tiered_t = caches::tiered_t<int, int, caches::LRU_t, caches::LRU_t>;
+    Test_t tests_exclusive[] = {{1, {1, 2, 1, 2}, 2},
+                                {1, {1, 2, 3, 1, 2, 3}, 6},
+                                {2, {1, 2, 3, 4, 1, 2, 3, 4}, 4},
+                                {2, {1, 2, 3, 1, 4, 5, 1}, 5}};
+    test_cache<Tiered_t, sizeof(tests_exclusive) / sizeof(Test_t)>(
+        tests_exclusive, "Exclusive tiered cache testing",
+        [](Test_t &t) { return Tiered_t(t.N, t.N, caches::tier_mode_t::exclusive); });
+
+    Test_t tests_inclusive[] = {{1, {1, 2, 1, 2}, 4},
+                                {2, {1, 2, 1, 2}, 2},
+                                {1, {1, 1, 2, 2}, 2},
+                                {2, {1, 2, 3, 1, 2, 3}, 6},
+                                // 1 is hit in L1 only, it must survive the churn in L2
+                                {2, {1, 2, 1, 3, 1, 4, 1, 5, 1}, 5}};
+    test_cache<Tiered_t, sizeof(tests_inclusive) / sizeof(Test_t)>(
+        tests_inclusive, "Inclusive tiered cache testing",
+        [](Test_t &t) { return Tiered_t(t.N, t.N, caches::tier_mode_t::inclusive); });
+}
+
+void test_write_back() {
+    std::cout << "Write-back cache testing" << std::endl;
+    using Cache_t = caches::write_back_t<int, int>;
+    std::vector<std::pair<int, int>> backend;
+    size_t n_batches = 0;
+    auto flush_cb = [&](const Cache_t::Batch_t &batch) {
+        n_batches++;
+        backend.insert(backend.end(), batch.begin(), batch.end());
+    };
+    auto slow_path = [](int key) -> int { return -key; };
+    const size_t N_tests = 5;
+
+    {
+        // repeated writes to one key coalesce into a single backend write
+        Cache_t cache(4, flush_cb, 4, std::chrono::hours(1));
+        for (int i = 0; i < 1000; i++)
+            cache.put(1, i);
+        cache.flush();
+        print_test_title(1, N_tests, backend.size() == 1 && backend[0] == std::make_pair(1, 999));
+    }
+    {
+        // dirty victims are batched: the callback fires once two of them were evicted
+        backend.clear();
+        n_batches = 0;
+        Cache_t cache(2, flush_cb, 2, std::chrono::hours(1));
+        cache.put(1, 10);
+        cache.put(2, 20);
+        cache.put(3, 30);
+        bool no_early_flush = backend.empty();
+        cache.put(4, 40);
+        print_test_title(2, N_tests, no_early_flush && n_batches == 1 && backend.size() == 2);
+    }
+    {
+        // evicted value waiting for its batch is served instead of the stale backend one
+        Cache_t cache(1, flush_cb, 8, std::chrono::hours(1));
+        cache.put(1, 10);
+        cache.look_update(2, slow_path);
+        bool served = cache.look_update(1, slow_path);
+        print_test_title(3, N_tests, served && cache.is_dirty(1));
+    }
+    {
+        // entries older than max_age are flushed by the next operation
+        backend.clear();
+        Cache_t cache(4, flush_cb, 8, std::chrono::nanoseconds(0));
+        cache.put(1, 10);
+        cache.look_update(2, slow_path);
+        print_test_title(4, N_tests, backend.size() == 1 && !cache.is_dirty(1));
+    }
+    {
+        // clean entries are never written back
+        backend.clear();
+        {
+            Cache_t cache(2, flush_cb, 1, std::chrono::hours(1));
+            for (int i = 0; i < 10; i++)
+                cache.look_update(i, slow_path);
+            cache.put(9, 90);
+        }
+        print_test_title(5, N_tests, backend.size() == 1 && backend[0] == std::make_pair(9, 90));
+    }
+}
+
+void test_autotune() {
+    std::cout << "Capacity autotuner testing" << std::endl;
+    auto slow_path = [](int key) -> int { return key; };
+    const size_t N_tests = 3;
+
+    // cyclic scan of 60 keys: LRU with 40 entries misses everything until it grows past the cliff
+    caches::autotuned_t<int, int> tuned(40, 10, 120, true);
+    caches::autotuned_t<int, int> advisor(40, 10, 120, false);
+    size_t misses = 0;
+    for (int round = 0; round < 10; round++)
+        for (int key = 0; key < 60; key++) {
+            misses += !tuned.look_update(key, slow_path);
+            advisor.look_update(key, slow_path);
+        }
+    print_test_title(1, N_tests, misses == 140 && tuned.capacity() >= 60);
+    print_test_title(2, N_tests, advisor.capacity() == 40 && advisor.recommended_capacity() == 60);
+
+    // working set of 16 keys: the cache shrinks down to it and stops there
+    caches::autotuned_t<int, int, caches::LFU_t> shrinking(64, 8, 256, true);
+    for (int i = 0; i < 2560; i++)
+        shrinking.look_update(i % 16, slow_path);
+    print_test_title(3, N_tests, shrinking.capacity() == 16);
+}
+
+void test_slab() {
+    std::cout << "Slab storage testing" << std::endl;
+    const size_t N_tests = 6;
+
+    // two 4KB slabs: one for 64-byte chunks, one for 1096-byte chunks (3 per slab)
+    caches::slab_LRU_t<int> cache(8192, 4096);
+    auto small = [](int key) { return std::string(50, 'a' + key % 26); };
+    auto large = [](int key) { return std::string(1000, 'a' + key % 26); };
+    for (int key = 0; key < 64; key++)
+        cache.look_update(key, small);
+    for (int key = 100; key < 103; key++)
+        cache.look_update(key, large);
+    caches::blob_t blob = cache.find(5);
+    print_test_title(1, N_tests, blob.data && std::string(blob.data, blob.size) == small(5));
+
+    // eviction stays inside the size class of the new value
+    cache.find(100);
+    bool hit = cache.look_update(103, large);
+    print_test_title(2, N_tests,
+                     !hit && cache.contains(100) && !cache.contains(101) && cache.size() == 67 && cache.contains(0));
+
+    // no memory left for a third class and a value bigger than a slab is never cached
+    print_test_title(3, N_tests, !cache.insert(200, std::string(100, 'x')) && !cache.insert(201, std::string(5000, 'x')));
+    print_test_title(4, N_tests, cache.memory_used() == 8192 && !cache.contains(200) && !cache.contains(201));
+
+    // a factor that doesn't grow an 8-byte chunk still gives strictly growing classes
+    caches::slab_allocator_t fine(1 << 16, 4096, 8, 1.1);
+    bool growing = fine.chunk_size(0) == 8 && fine.chunk_size(fine.n_classes() - 1) == 4096;
+    for (size_t cls = 1; cls < fine.n_classes(); cls++)
+        growing = growing && fine.chunk_size(cls) >= fine.chunk_size(cls - 1) + 8;
+    print_test_title(5, N_tests, growing && fine.n_classes() < 64);
+
+    size_t n_rejected = 0;
+    for (auto args : {std::make_pair(size_t(0), 1.25), std::make_pair(size_t(64), 1.0)}) {
+        try {
+            caches::slab_allocator_t bad(1 << 16, 4096, args.first, args.second);
+        } catch (const std::invalid_argument &) {
+            n_rejected++;
+        }
+    }
+    print_test_title(6, N_tests, n_rejected == 2);
 }
 
 void cache_comparison() {
@@ -105,24 +367,103 @@ void cache_comparison() {
     for (size_t i = 0; i < N_tests; i++) {
         caches::perfect_t<int, int> cache_0(tests[i].N, tests[i].req);
         caches::LFU_t<int, int> cache_1(tests[i].N);
+        caches::LRU_t<int, int> cache_2(tests[i].N);
+        caches::adaptive_t<int, int> cache_3(tests[i].N);
+        caches::hawkeye_t<int, int> cache_4(tests[i].N);
 
         size_t misses_0 = 0;
         size_t misses_1 = 0;
+        size_t misses_2 = 0;
+        size_t misses_3 = 0;
+        size_t misses_4 = 0;
         auto slow_path = [](int key) -> int { return key; };
         for (const auto &it : tests[i].req) {
             misses_0 += !cache_0.look_update(it, slow_path);
             misses_1 += !cache_1.look_update(it, slow_path);
+            misses_2 += !cache_2.look_update(it, slow_path);
+            misses_3 += !cache_3.look_update(it, slow_path);
+            misses_4 += !cache_4.look_update(it, slow_path);
         }
 
         std::cout << std::setw(8) << "perfect = " << std::setw(3) << misses_0 << std::setw(8)
-                  << "LFU = " << std::setw(3) << misses_1 << std::endl;
+                  << "LFU = " << std::setw(3) << misses_1 << std::setw(8) << "LRU = " << std::setw(3) << misses_2
+                  << std::setw(12) << "adaptive = " << std::setw(3) << misses_3 << std::setw(12)
+                  << "hawkeye = " << std::setw(3) << misses_4 << std::endl;
+    }
+}
+
+void prefetch_report() {
+    // stream 0 scans blocks sequentially, stream 1 reads short runs of 3 blocks at random places
+    caches::prefetcher_t<int, int> cache(64, 4);
+    auto slow_path = [](int key) -> int { return key; };
+    unsigned random = 1;
+    int run_start = 0;
+    size_t misses = 0;
+    const size_t N_requests = 20000;
+    for (size_t i = 0; i < N_requests; i++) {
+        if (i % 2) {
+            misses += !cache.look_update(static_cast<int>(i / 2), slow_path, 0);
+            continue;
+        }
+        if (i % 6 == 0) {
+            random = random * 1103515245u + 12345u;
+            run_start = 1000000 + (random >> 8) % 100000;
+        }
+        misses += !cache.look_update(run_start + static_cast<int>(i % 6) / 2, slow_path, 1);
+    }
+
+    auto &stats = cache.stats();
+    std::cout << "Prefetch report" << std::endl;
+    std::cout << "misses = " << misses << "/" << N_requests << ", issued = " << stats.issued
+              << ", hit rate = " << stats.hit_rate() << ", waste rate = " << stats.waste_rate() << std::endl;
+}
+
+// For every trace "cache_size n_requests keys..." from the stream prints misses of
+// the online policies next to the optimal ones with and without caching single pages.
+void report(std::istream &in) {
+    using Key_t = uint64_t;
+    const int w = 10;
+    std::cout << std::setw(6) << "trace" << std::setw(w) << "size" << std::setw(w) << "requests" << std::setw(w)
+              << "LRU" << std::setw(w) << "LFU" << std::setw(w) << "WLFU" << std::setw(w) << "adaptive" << std::setw(w)
+              << "OPT" << std::setw(w) << "OPT-skip" << std::endl;
+
+    size_t cache_size = 0;
+    size_t req_amount = 0;
+    for (size_t trace = 1; in >> cache_size >> req_amount; trace++) {
+        std::vector<Key_t> req(req_amount);
+        for (auto &r : req)
+            in >> r;
+
+        caches::LRU_t<Key_t, Key_t> lru(cache_size);
+        caches::LFU_t<Key_t, Key_t> lfu(cache_size);
+        caches::WLFU_t<Key_t, Key_t> wlfu(cache_size, 8 * cache_size);
+        caches::adaptive_t<Key_t, Key_t> adaptive(cache_size);
+        size_t misses[4] = {};
+        auto slow_path = [](Key_t key) -> Key_t { return key; };
+        for (const auto &it : req) {
+            misses[0] += !lru.look_update(it, slow_path);
+            misses[1] += !lfu.look_update(it, slow_path);
+            misses[2] += !wlfu.look_update(it, slow_path);
+            misses[3] += !adaptive.look_update(it, slow_path);
+        }
+        size_t opt = caches::perfect_t<Key_t, Key_t>(cache_size, req, false).misses_amount();
+        size_t opt_skip = caches::perfect_t<Key_t, Key_t>(cache_size, req, true).misses_amount();
+
+        std::cout << std::setw(6) << trace << std::setw(w) << cache_size << std::setw(w) << req_amount;
+        for (auto m : misses)
+            std::cout << std::setw(w) << m;
+        std::cout << std::setw(w) << opt << std::setw(w) << opt_skip << std::endl;
     }
 }
 
-int main() {
+int main(int argc, char **argv) {
 #ifdef TESTS
     test_caches();
+    test_write_back();
+    test_autotune();
+    test_slab();
     cache_comparison();
+    prefetch_report();
 #elif LFU
     size_t cache_size = 0;
     size_t req_amount = 0;
@@ -137,6 +478,43 @@ int main() {
         hits += cache.look_update(req, slow_path);
     }
     std::cout << hits << std::endl;
+#elif STREAM
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0] << " <trace file> [max window]" << std::endl;
+        return 1;
+    }
+    std::ifstream trace(argv[1]);
+    size_t cache_size = 0;
+    size_t req_amount = 0;
+    trace >> cache_size >> req_amount;
+    auto data_begin = trace.tellg();
+
+    // memory grows with the window, so the whole trace is only looked ahead if asked for;
+    // errors are measured against the largest window, which is exact once it covers the trace
+    size_t max_window = argc > 2 ? std::stoull(argv[2]) : size_t(1) << 20;
+    max_window = std::max(std::min(max_window, req_amount), std::max<size_t>(cache_size, 1));
+    std::vector<std::pair<size_t, size_t>> rows;
+    for (size_t window = std::max<size_t>(cache_size, 1);; window *= 2) {
+        window = std::min(window, max_window);
+        trace.clear();
+        trace.seekg(data_begin);
+        rows.emplace_back(window, caches::stream_perfect_t<int>(cache_size, window).misses_amount(trace, req_amount));
+        if (window >= max_window)
+            break;
+    }
+
+    const size_t best = rows.back().second;
+    std::cout << (max_window >= req_amount ? "errors against the exact bound" : "errors against the largest window")
+              << std::endl;
+    std::cout << std::setw(10) << "window" << std::setw(12) << "misses" << std::setw(10) << "error"
+              << std::setw(12) << "error, %" << std::endl;
+    for (const auto &row : rows)
+        std::cout << std::setw(10) << row.first << std::setw(12) << row.second << std::setw(10)
+                  << static_cast<long long>(row.second) - static_cast<long long>(best) << std::setw(12)
+                  << std::fixed << std::setprecision(3)
+                  << (best ? 100.0 * (static_cast<double>(row.second) - best) / best : 0.0) << std::endl;
+#elif REPORT
+    report(std::cin);
 #elif PERFECT
     size_t cache_size = 0;
     size_t req_amount = 0;
@@ -0,0 +1,117 @@
+#pragma once
+#include "cache.hpp"
+#include <type_traits>
+
+namespace caches {
+
+struct prefetch_stats_t {
+    size_t issued = 0;
+    size_t useful = 0; // prefetched entry was requested before eviction
+    size_t wasted = 0; // prefetched entry was evicted untouched
+
+    double hit_rate() const { return issued ? double(useful) / issued : 0.0; }
+    double waste_rate() const { return issued ? double(wasted) / issued : 0.0; }
+};
+
+// Detects constant-stride runs of integer keys per stream and loads the next
+// `degree` keys of a run through slow_path before they are requested.
+// Prefetched entries are admitted with low priority. A stream whose recent
+// prefetches were mostly wasted pauses for `backoff` requests, the pause doubles
+// while the accuracy stays low.
+template <typename Key_t, typename Val_t, template <typename, typename> class Policy = LRU_t> class prefetcher_t {
+    static_assert(std::is_integral<Key_t>::value, "stride detection needs integer keys");
+
+public:
+    prefetcher_t(size_t size, size_t degree = 2, double min_accuracy = 0.5, size_t backoff = 64)
+        : cache_(size), degree_(degree), min_accuracy_(min_accuracy), backoff_(backoff) {}
+
+    template <typename F> bool look_update(Key_t key, F slow_path, size_t stream = 0) {
+        requests_++;
+        auto on_evict = [this](const Key_t &victim, Val_t &) { resolve(victim, false); };
+
+        bool hit = cache_.find(key) != nullptr;
+        if (hit)
+            resolve(key, true);
+        else
+            cache_.insert(key, slow_path(key), on_evict);
+
+        auto &s = streams_[stream];
+        long long stride = s.seen ? static_cast<long long>(key) - static_cast<long long>(s.last) : 0;
+        if (stride == s.stride && stride != 0) {
+            s.confidence++;
+        } else {
+            s.stride = stride;
+            s.confidence = 0;
+        }
+        s.last = key;
+        s.seen = true;
+
+        if (s.confidence == 0 || requests_ < s.off_until)
+            return hit;
+
+        for (size_t d = 1; d <= degree_; d++) {
+            Key_t next = static_cast<Key_t>(static_cast<long long>(key) + s.stride * static_cast<long long>(d));
+            if (cache_.contains(next))
+                continue;
+            stats_.issued++;
+            in_flight_[next] = stream;
+            cache_.insert(next, slow_path(next), on_evict, admission_t::low);
+        }
+        return hit;
+    }
+
+    const prefetch_stats_t &stats() const { return stats_; }
+    const Policy<Key_t, Val_t> &cache() const { return cache_; }
+
+private:
+    struct stream_t {
+        Key_t last = 0;
+        long long stride = 0;
+        size_t confidence = 0;
+        bool seen = false;
+        // accuracy of the recent prefetches, both halved once they reach the window
+        size_t useful = 0;
+        size_t resolved = 0;
+        size_t off_until = 0;
+        size_t backoff = 0;
+    };
+
+    enum : size_t { accuracy_window_ = 32, max_backoff_factor_ = 64 };
+
+    Policy<Key_t, Val_t> cache_;
+    size_t degree_;
+    double min_accuracy_;
+    size_t backoff_;
+    size_t requests_ = 0;
+
+    prefetch_stats_t stats_;
+    std::unordered_map<size_t, stream_t> streams_;
+    // prefetched and not yet requested key -> stream which issued it
+    std::unordered_map<Key_t, size_t> in_flight_;
+
+    void resolve(const Key_t &key, bool useful) {
+        auto it = in_flight_.find(key);
+        if (it == in_flight_.end())
+            return;
+
+        auto &s = streams_[it->second];
+        in_flight_.erase(it);
+        (useful ? stats_.useful : stats_.wasted)++;
+
+        s.useful += useful;
+        s.resolved++;
+        if (s.resolved >= accuracy_window_) {
+            if (s.useful < min_accuracy_ * s.resolved) {
+                // every consecutive inaccurate window doubles the pause
+                s.backoff = s.backoff ? std::min(2 * s.backoff, max_backoff_factor_ * backoff_) : backoff_;
+                s.off_until = requests_ + s.backoff;
+            } else {
+                s.backoff = 0;
+            }
+            s.useful /= 2;
+            s.resolved /= 2;
+        }
+    }
+};
+
+} // namespace caches
@@ -0,0 +1,230 @@
+#pragma once
+#include "cache.hpp"
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+
+namespace caches {
+
+// Hands out fixed size chunks from large mmap'd slabs. Chunk sizes form
+// geometric size classes, each at least 8 bytes bigger than the previous one,
+// a slab belongs to one class for its whole life and no more than
+// memory_limit bytes of slabs are ever mapped.
+class slab_allocator_t {
+public:
+    static const size_t npos = std::numeric_limits<size_t>::max();
+
+    slab_allocator_t(size_t memory_limit, size_t slab_size = 1 << 20, size_t min_chunk = 64, double factor = 1.25)
+        : memory_limit_(memory_limit), slab_size_(slab_size) {
+        if (min_chunk == 0 || !(factor > 1))
+            throw std::invalid_argument("slab size classes need min_chunk > 0 and factor > 1");
+        for (size_t chunk = round8(min_chunk); chunk < slab_size_;
+             chunk = std::max(chunk + 8, round8(static_cast<size_t>(chunk * factor))))
+            classes_.push_back(class_t{chunk, slab_size_ / chunk});
+        classes_.push_back(class_t{slab_size_, 1});
+    }
+
+    slab_allocator_t(const slab_allocator_t &) = delete;
+    slab_allocator_t &operator=(const slab_allocator_t &) = delete;
+
+    ~slab_allocator_t() {
+        for (auto &c : classes_)
+            for (auto slab : c.slabs)
+                munmap(slab, slab_size_);
+    }
+
+    size_t class_of(size_t bytes) const {
+        for (size_t cls = 0; cls < classes_.size(); cls++)
+            if (classes_[cls].chunk >= bytes)
+                return cls;
+        return npos;
+    }
+
+    // returns the index of a free chunk of the class, npos if the class is full and no slab can be mapped
+    size_t allocate(size_t cls) {
+        auto &c = classes_[cls];
+        if (c.free.empty() && !grow(c))
+            return npos;
+        size_t idx = c.free.back();
+        c.free.pop_back();
+        return idx;
+    }
+
+    void release(size_t cls, size_t idx) { classes_[cls].free.push_back(static_cast<uint32_t>(idx)); }
+
+    char *data(size_t cls, size_t idx) {
+        auto &c = classes_[cls];
+        return c.slabs[idx / c.per_slab] + (idx % c.per_slab) * c.chunk;
+    }
+
+    size_t chunk_size(size_t cls) const { return classes_[cls].chunk; }
+    size_t chunks(size_t cls) const { return classes_[cls].slabs.size() * classes_[cls].per_slab; }
+    size_t n_classes() const { return classes_.size(); }
+    size_t memory_used() const { return memory_used_; }
+
+private:
+    struct class_t {
+        size_t chunk;
+        size_t per_slab;
+        std::vector<char *> slabs;
+        std::vector<uint32_t> free;
+
+        class_t(size_t chunk_size, size_t n) : chunk(chunk_size), per_slab(n) {}
+    };
+
+    size_t memory_limit_;
+    size_t slab_size_;
+    size_t memory_used_ = 0;
+    std::vector<class_t> classes_;
+
+    static size_t round8(size_t bytes) { return (bytes + 7) & ~size_t(7); }
+
+    bool grow(class_t &c) {
+        if (memory_used_ + slab_size_ > memory_limit_)
+            return false;
+        void *slab = mmap(nullptr, slab_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (slab == MAP_FAILED)
+            throw std::bad_alloc();
+
+        size_t first = c.slabs.size() * c.per_slab;
+        c.slabs.push_back(static_cast<char *>(slab));
+        memory_used_ += slab_size_;
+        for (size_t i = c.per_slab; i-- > 0;)
+            c.free.push_back(static_cast<uint32_t>(first + i));
+        return true;
+    }
+};
+
+struct blob_t {
+    const char *data;
+    size_t size;
+};
+
+// LRU cache of byte string values kept off the heap in slab chunks. The index
+// maps a key to an 8-byte handle, recency is an intrusive list per size class,
+// so eviction happens inside the class of the incoming value, as in memcached.
+// Values bigger than a slab are not cached.
+template <typename Key_t> class slab_LRU_t {
+public:
+    slab_LRU_t(size_t memory_limit, size_t slab_size = 1 << 20, size_t min_chunk = 64, double factor = 1.25)
+        : slabs_(memory_limit, slab_size, min_chunk, factor), lru_(slabs_.n_classes()) {
+        if (slabs_.n_classes() > (size_t(1) << (64 - class_shift)))
+            throw std::invalid_argument("too many slab size classes for the handle, use a bigger factor");
+    }
+
+    // slow_path(key) returns the value as std::string
+    template <typename F> bool look_update(Key_t key, F slow_path) {
+        if (find(key).data)
+            return true;
+        insert(key, slow_path(key));
+        return false;
+    }
+
+    // the view is valid until the next insert
+    blob_t find(const Key_t &key) {
+        auto hit = index_.find(key);
+        if (hit == index_.end())
+            return blob_t{nullptr, 0};
+
+        size_t cls = hit->second >> class_shift;
+        size_t idx = hit->second & chunk_mask;
+        unlink(cls, idx);
+        link_front(cls, idx);
+        return view(cls, idx);
+    }
+
+    bool insert(const Key_t &key, const std::string &val) {
+        auto hit = index_.find(key);
+        if (hit != index_.end())
+            remove(hit);
+
+        size_t cls = slabs_.class_of(val.size() + sizeof(uint32_t));
+        if (cls == slab_allocator_t::npos)
+            return false;
+
+        size_t idx = slabs_.allocate(cls);
+        if (idx == slab_allocator_t::npos) {
+            auto &l = lru_[cls];
+            if (l.tail == nil)
+                return false;
+            remove(index_.find(l.keys[l.tail]));
+            idx = slabs_.allocate(cls);
+        }
+
+        auto &l = lru_[cls];
+        if (l.keys.size() < slabs_.chunks(cls)) {
+            l.keys.resize(slabs_.chunks(cls));
+            l.prev.resize(slabs_.chunks(cls), nil);
+            l.next.resize(slabs_.chunks(cls), nil);
+        }
+        l.keys[idx] = key;
+        link_front(cls, idx);
+
+        char *chunk = slabs_.data(cls, idx);
+        uint32_t len = static_cast<uint32_t>(val.size());
+        std::memcpy(chunk, &len, sizeof(len));
+        std::memcpy(chunk + sizeof(len), val.data(), val.size());
+        index_[key] = (static_cast<uint64_t>(cls) << class_shift) | idx;
+        return true;
+    }
+
+    bool contains(const Key_t &key) const { return index_.count(key); }
+    size_t size() const { return index_.size(); }
+    size_t memory_used() const { return slabs_.memory_used(); }
+
+private:
+    // handle: size class in the top byte, chunk index inside the class below it
+    enum : uint32_t { nil = std::numeric_limits<uint32_t>::max() };
+    enum : uint64_t { class_shift = 56, chunk_mask = (uint64_t(1) << class_shift) - 1 };
+
+    struct class_lru_t {
+        uint32_t head = nil;
+        uint32_t tail = nil;
+        std::vector<uint32_t> prev;
+        std::vector<uint32_t> next;
+        std::vector<Key_t> keys;
+    };
+
+    slab_allocator_t slabs_;
+    std::vector<class_lru_t> lru_;
+    std::unordered_map<Key_t, uint64_t> index_;
+
+    blob_t view(size_t cls, size_t idx) {
+        char *chunk = slabs_.data(cls, idx);
+        uint32_t len = 0;
+        std::memcpy(&len, chunk, sizeof(len));
+        return blob_t{chunk + sizeof(len), len};
+    }
+
+    void remove(typename std::unordered_map<Key_t, uint64_t>::iterator it) {
+        size_t cls = it->second >> class_shift;
+        size_t idx = it->second & chunk_mask;
+        unlink(cls, idx);
+        slabs_.release(cls, idx);
+        index_.erase(it);
+    }
+
+    void link_front(size_t cls, size_t idx) {
+        auto &l = lru_[cls];
+        l.prev[idx] = nil;
+        l.next[idx] = l.head;
+        if (l.head != nil)
+            l.prev[l.head] = static_cast<uint32_t>(idx);
+        l.head = static_cast<uint32_t>(idx);
+        if (l.tail == nil)
+            l.tail = l.head;
+    }
+
+    void unlink(size_t cls, size_t idx) {
+        auto &l = lru_[cls];
+        uint32_t p = l.prev[idx];
+        uint32_t n = l.next[idx];
+        (p == nil ? l.head : l.next[p]) = n;
+        (n == nil ? l.tail : l.prev[n]) = p;
+    }
+};
+
+} // namespace caches
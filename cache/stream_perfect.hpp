@@ -0,0 +1,134 @@
+#pragma once
+#include "cache.hpp"
+#include <deque>
+#include <istream>
+#include <map>
+
+namespace caches {
+
+// Reads whitespace separated keys from a stream `chunk` keys at a time.
+template <typename Key_t> class chunk_reader_t {
+public:
+    chunk_reader_t(std::istream &in, size_t n_keys, size_t chunk = 4096)
+        : in_(in), left_(n_keys), buf_(std::max<size_t>(chunk, 1)) {}
+
+    bool next(Key_t &key) {
+        if (pos_ == filled_ && !refill())
+            return false;
+        key = buf_[pos_++];
+        return true;
+    }
+
+private:
+    std::istream &in_;
+    size_t left_;
+    std::vector<Key_t> buf_;
+    size_t pos_ = 0;
+    size_t filled_ = 0;
+
+    bool refill() {
+        pos_ = filled_ = 0;
+        while (filled_ < buf_.size() && left_ && in_ >> buf_[filled_]) {
+            filled_++;
+            left_--;
+        }
+        return filled_ != 0;
+    }
+};
+
+// Belady's algorithm over a stream: the next use of a key is only looked up
+// inside the following `window` requests, anything farther counts as infinity.
+// Keys with an unknown next use are evicted in LRU order. Memory is
+// O(window + size), with window >= number of requests the result is exact.
+template <typename Key_t> class stream_perfect_t {
+public:
+    stream_perfect_t(size_t size, size_t window, bool skip_singles = skip_singles_default)
+        : size_(size), window_(std::max<size_t>(window, 1)), skip_singles_(skip_singles) {}
+
+    size_t misses_amount(std::istream &in, size_t req_amount) {
+        chunk_reader_t<Key_t> reader(in, req_amount);
+        reset();
+
+        size_t total_misses = 0;
+        size_t read = 0;
+        Key_t key;
+        for (size_t cur = 0; cur < req_amount; cur++) {
+            // keep requests [cur, cur + window] in the lookahead buffer
+            while (read <= cur + window_ && read < req_amount && reader.next(key))
+                push_future(key, read++);
+            if (future_.empty())
+                break;
+
+            key = future_.front();
+            future_.pop_front();
+            auto occ = occurrences_.find(key);
+            occ->second.pop_front();
+            size_t next = detail::never;
+            if (occ->second.empty())
+                occurrences_.erase(occ);
+            else
+                next = occ->second.front();
+
+            auto hit = cache_table_.find(key);
+            if (hit != cache_table_.end()) {
+                order_.erase(hit->second);
+                hit->second = order_.emplace(rank(next), key).first;
+                continue;
+            }
+
+            total_misses++;
+            if (!size_ || (skip_singles_ && next == detail::never))
+                continue;
+            if (cache_table_.size() >= size_) {
+                auto victim = std::prev(order_.end());
+                cache_table_.erase(victim->second);
+                order_.erase(victim);
+            }
+            cache_table_[key] = order_.emplace(rank(next), key).first;
+        }
+
+        return total_misses;
+    }
+
+private:
+    size_t size_;
+    size_t window_;
+    bool skip_singles_;
+    size_t stamp_ = 0;
+
+    std::deque<Key_t> future_;
+    std::unordered_map<Key_t, std::deque<size_t>> occurrences_;
+
+    // (next use, inverted stamp): the last element is the farthest one, ties are broken towards the oldest entry
+    using Rank_t = std::pair<size_t, size_t>;
+    using Order_t = std::map<Rank_t, Key_t>;
+    Order_t order_;
+    std::unordered_map<Key_t, typename Order_t::iterator> cache_table_;
+
+    Rank_t rank(size_t next) { return Rank_t{next, detail::never - stamp_++}; }
+
+    void push_future(const Key_t &key, size_t idx) {
+        future_.push_back(key);
+        auto &occ = occurrences_[key];
+        bool was_unknown = occ.empty();
+        occ.push_back(idx);
+
+        // a cached key just got its next use inside the window
+        auto cached = cache_table_.find(key);
+        if (was_unknown && cached != cache_table_.end()) {
+            Rank_t r{idx, cached->second->first.second};
+            order_.erase(cached->second);
+            cached->second = order_.emplace(r, key).first;
+        }
+    }
+
+    void reset() {
+        future_.clear();
+        occurrences_.clear();
+        order_.clear();
+        cache_table_.clear();
+        stamp_ = 0;
+    }
+};
+
+} // namespace caches
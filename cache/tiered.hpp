@@ -0,0 +1,101 @@
+#pragma once
+#include "cache.hpp"
+
+namespace caches {
+
+enum class tier_mode_t {
+    inclusive, // every L1 entry is also kept in L2, L2 evictions invalidate L1
+    exclusive  // a key lives in exactly one tier, L1 victims are demoted into L2
+};
+
+struct tier_stats_t {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t insertions = 0;
+    size_t evictions = 0;
+};
+
+template <typename Key_t, typename Val_t, template <typename, typename> class L1_policy = LRU_t,
+          template <typename, typename> class L2_policy = LFU_t>
+class tiered_t {
+public:
+    tiered_t(size_t l1_size, size_t l2_size, tier_mode_t mode = tier_mode_t::exclusive)
+        : l1_(l1_size), l2_(l2_size), mode_(mode) {}
+
+    template <typename F> bool look_update(Key_t key, F slow_path) {
+        if (l1_.find(key)) {
+            l1_stats_.hits++;
+            // keep the L2 copy of a hot key recent too, otherwise L2 evicts it
+            // first and the invalidation drops it from L1; not counted as an L2 hit
+            if (mode_ == tier_mode_t::inclusive)
+                l2_.find(key);
+            return true;
+        }
+        l1_stats_.misses++;
+
+        Val_t *l2_val = l2_.find(key);
+        if (l2_val) {
+            l2_stats_.hits++;
+            promotions_++;
+            if (mode_ == tier_mode_t::exclusive) {
+                Val_t val = std::move(*l2_val);
+                l2_.erase(key);
+                insert_l1(key, std::move(val));
+            } else {
+                insert_l1(key, *l2_val);
+            }
+            return true;
+        }
+        l2_stats_.misses++;
+
+        Val_t val = slow_path(key);
+        if (mode_ == tier_mode_t::inclusive)
+            insert_l2(key, val);
+        insert_l1(key, std::move(val));
+        return false;
+    }
+
+    bool contains(const Key_t &key) const { return l1_.contains(key) || l2_.contains(key); }
+
+    tier_mode_t mode() const { return mode_; }
+    const tier_stats_t &l1_stats() const { return l1_stats_; }
+    const tier_stats_t &l2_stats() const { return l2_stats_; }
+    size_t promotions() const { return promotions_; }
+    size_t demotions() const { return demotions_; }
+
+    const L1_policy<Key_t, Val_t> &l1() const { return l1_; }
+    const L2_policy<Key_t, Val_t> &l2() const { return l2_; }
+
+private:
+    L1_policy<Key_t, Val_t> l1_;
+    L2_policy<Key_t, Val_t> l2_;
+    tier_mode_t mode_;
+
+    tier_stats_t l1_stats_;
+    tier_stats_t l2_stats_;
+    size_t promotions_ = 0;
+    size_t demotions_ = 0;
+
+    void insert_l1(Key_t key, Val_t val) {
+        l1_stats_.insertions++;
+        l1_.insert(key, std::move(val), [this](const Key_t &victim, Val_t &victim_val) {
+            l1_stats_.evictions++;
+            // in inclusive mode the victim is still present in L2
+            if (mode_ == tier_mode_t::exclusive) {
+                demotions_++;
+                insert_l2(victim, std::move(victim_val));
+            }
+        });
+    }
+
+    void insert_l2(Key_t key, Val_t val) {
+        l2_stats_.insertions++;
+        l2_.insert(key, std::move(val), [this](const Key_t &victim, Val_t &) {
+            l2_stats_.evictions++;
+            if (mode_ == tier_mode_t::inclusive)
+                l1_.erase(victim);
+        });
+    }
+};
+
+} // namespace caches
@@ -0,0 +1,153 @@
+#pragma once
+#include "cache.hpp"
+#include <chrono>
+#include <deque>
+#include <functional>
+
+namespace caches {
+
+struct write_back_stats_t {
+    size_t writes = 0;         // put() calls
+    size_t backend_writes = 0; // entries handed to the flush callback
+    size_t flushes = 0;        // flush callback invocations
+};
+
+// Write-back cache: put() only marks the entry dirty, repeated writes to the
+// same key coalesce. Dirty entries reach the backend in batches through the
+// flush callback when they are evicted, when they stay dirty longer than
+// max_age or on explicit flush(). Evicted dirty entries wait for their batch in
+// a pending buffer that is also consulted on reads.
+template <typename Key_t, typename Val_t, template <typename, typename> class Policy = LRU_t> class write_back_t {
+public:
+    using Batch_t = std::vector<std::pair<Key_t, Val_t>>;
+    using Flush_t = std::function<void(const Batch_t &)>;
+    using Clock_t = std::chrono::steady_clock;
+
+    write_back_t(size_t size, Flush_t flush_cb, size_t batch_size = 32,
+                 Clock_t::duration max_age = std::chrono::seconds(1))
+        : cache_(size), flush_cb_(flush_cb), batch_size_(std::max<size_t>(batch_size, 1)), max_age_(max_age) {}
+
+    write_back_t(const write_back_t &) = delete;
+    write_back_t &operator=(const write_back_t &) = delete;
+
+    ~write_back_t() { flush(); }
+
+    template <typename F> bool look_update(Key_t key, F slow_path) {
+        flush_expired();
+        if (cache_.find(key))
+            return true;
+
+        // written value is still waiting for the backend, slow path would return stale data
+        auto pending = pending_index_.find(key);
+        if (pending != pending_index_.end()) {
+            cache_.insert(key, pending_[pending->second].second, on_evict());
+            return true;
+        }
+
+        cache_.insert(key, slow_path(key), on_evict());
+        return false;
+    }
+
+    void put(Key_t key, Val_t val) {
+        flush_expired();
+        stats_.writes++;
+
+        // the newer value supersedes the one waiting in the pending batch
+        drop_pending(key);
+        cache_.insert(key, std::move(val), on_evict());
+        if (!dirty_.count(key)) {
+            auto now = Clock_t::now();
+            dirty_[key] = now;
+            dirty_order_.emplace_back(now, key);
+        }
+    }
+
+    void flush() {
+        for (const auto &d : dirty_)
+            add_pending(d.first, *cache_.peek(d.first));
+        dirty_.clear();
+        dirty_order_.clear();
+        emit();
+    }
+
+    bool is_dirty(const Key_t &key) const { return dirty_.count(key) || pending_index_.count(key); }
+    const write_back_stats_t &stats() const { return stats_; }
+
+private:
+    Policy<Key_t, Val_t> cache_;
+    Flush_t flush_cb_;
+    size_t batch_size_;
+    Clock_t::duration max_age_;
+    write_back_stats_t stats_;
+
+    // dirty key -> moment it became dirty, the queue keeps the same pairs in that order
+    std::unordered_map<Key_t, Clock_t::time_point> dirty_;
+    std::deque<std::pair<Clock_t::time_point, Key_t>> dirty_order_;
+
+    Batch_t pending_;
+    std::unordered_map<Key_t, size_t> pending_index_;
+
+    struct on_evict_t {
+        write_back_t *self;
+        void operator()(const Key_t &key, Val_t &val) const {
+            if (!self->dirty_.erase(key))
+                return;
+            self->add_pending(key, std::move(val));
+            if (self->pending_.size() >= self->batch_size_)
+                self->emit();
+        }
+    };
+    on_evict_t on_evict() { return on_evict_t{this}; }
+
+    void flush_expired() {
+        if (dirty_order_.empty())
+            return;
+
+        auto now = Clock_t::now();
+        bool expired = false;
+        while (!dirty_order_.empty() && now - dirty_order_.front().first >= max_age_) {
+            auto &front = dirty_order_.front();
+            auto it = dirty_.find(front.second);
+            // stale queue entry: the key was flushed and dirtied again later
+            if (it != dirty_.end() && it->second == front.first) {
+                add_pending(front.second, *cache_.peek(front.second));
+                dirty_.erase(it);
+                expired = true;
+            }
+            dirty_order_.pop_front();
+        }
+        if (expired)
+            emit();
+    }
+
+    void add_pending(const Key_t &key, Val_t val) {
+        pending_index_[key] = pending_.size();
+        pending_.emplace_back(key, std::move(val));
+    }
+
+    void drop_pending(const Key_t &key) {
+        auto it = pending_index_.find(key);
+        if (it == pending_index_.end())
+            return;
+
+        size_t idx = it->second;
+        pending_index_.erase(it);
+        if (idx + 1 != pending_.size()) {
+            pending_[idx] = std::move(pending_.back());
+            pending_index_[pending_[idx].first] = idx;
+        }
+        pending_.pop_back();
+    }
+
+    void emit() {
+        if (pending_.empty())
+            return;
+        stats_.flushes++;
+        stats_.backend_writes += pending_.size();
+        flush_cb_(pending_);
+        pending_.clear();
+        pending_index_.clear();
+    }
+};
+
+} // namespace caches